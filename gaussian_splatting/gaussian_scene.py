@@ -2,6 +2,7 @@ import time
 from pathlib import Path
 from tqdm import tqdm
 
+import numpy as np
 import torch
 from torch import nn
 
@@ -155,7 +156,11 @@ class GaussianScene(nn.Module):
         opacities: torch.Tensor,
         inverse_covariance: torch.Tensor,
         min_weight: float = 0.000001,
+        stats: dict = None,
     ) -> torch.Tensor:
+        """
+        stats, when given, is the tile's counter dict from render_tile.
+        """
         total_weight = torch.ones(1).to(points_in_tile_mean.device)
         pixel_color = torch.zeros((1, 1, 3)).to(points_in_tile_mean.device)
         for point_idx in range(points_in_tile_mean.shape[0]):
@@ -168,12 +173,57 @@ class GaussianScene(nn.Module):
             alpha = weight * torch.sigmoid(opacities[point_idx])
             test_weight = total_weight * (1 - alpha)
             if test_weight < min_weight:
+                self._record_saturation(stats, point_idx + 1)
                 return pixel_color
             pixel_color += total_weight * alpha * colors[point_idx]
             total_weight = test_weight
+            self._record_contribution(stats, point_idx, pixel_coords)
         # in case we never reach saturation
+        self._record_saturation(stats, None)
         return pixel_color
 
+    def render_pixel_depth(
+        self,
+        pixel_coords: torch.Tensor,
+        points_in_tile_mean: torch.Tensor,
+        depths: torch.Tensor,
+        opacities: torch.Tensor,
+        inverse_covariance: torch.Tensor,
+        output_depth: bool = True,
+        min_weight: float = 0.000001,
+        stats: dict = None,
+    ) -> torch.Tensor:
+        """
+        Same compositing as render_pixel without colors. Returns the accumulated alpha,
+        or the expected depth normalized by it when output_depth is set.
+        """
+        total_weight = torch.ones(1).to(points_in_tile_mean.device)
+        pixel_depth = torch.zeros(1).to(points_in_tile_mean.device)
+        saturated_at = None
+        for point_idx in range(points_in_tile_mean.shape[0]):
+            point = points_in_tile_mean[point_idx, :].view(1, 2)
+            weight = compute_gaussian_weight(
+                pixel_coord=pixel_coords,
+                point_mean=point,
+                inverse_covariance=inverse_covariance[point_idx],
+            )
+            alpha = weight * torch.sigmoid(opacities[point_idx])
+            test_weight = total_weight * (1 - alpha)
+            if test_weight < min_weight:
+                saturated_at = point_idx + 1
+                break
+            pixel_depth += total_weight * alpha * depths[point_idx]
+            total_weight = test_weight
+            self._record_contribution(stats, point_idx, pixel_coords)
+        self._record_saturation(stats, saturated_at)
+
+        accumulated_alpha = 1 - total_weight
+        if not output_depth:
+            return accumulated_alpha
+        if accumulated_alpha <= 0:
+            return torch.zeros_like(pixel_depth)
+        return pixel_depth / accumulated_alpha
+
     def render_tile(
         self,
         x_min: int,
@@ -183,31 +233,132 @@ class GaussianScene(nn.Module):
         opacities: torch.Tensor,
         inverse_covariance: torch.Tensor,
         tile_size: int = 16,
+        mode: str = "color",
+        depths: torch.Tensor = None,
+        tile_stats: dict = None,
+        bounds: torch.Tensor = None,
+        batch_size: int = 256,
     ) -> torch.Tensor:
-        """Points in tile should be arranged in order of depth"""
+        """
+        Points in tile should be arranged in order of depth.
+        mode is "color" (3 channels), or "depth"/"alpha" (1 channel, needs depths).
+        tile_stats, when given, receives the tile's workload counters (see render_image).
+        bounds (min_x, max_x, min_y, max_y per point) and batch_size are only used for them.
+        """
+
+        channels = 3 if mode == "color" else 1
+        tile = torch.zeros((tile_size, tile_size, channels))
 
-        tile = torch.zeros((tile_size, tile_size, 3))
+        point_count = points_in_tile_mean.shape[0]
+        stats = None
+        if tile_stats is not None:
+            stats = {
+                "contributed": torch.zeros(point_count, dtype=torch.bool),
+                "walked": 0,
+                "saturated_at": 0,
+                "all_saturated": True,
+                "bounds": bounds,
+            }
 
         for pixel_x in range(x_min, x_min + tile_size):
             for pixel_y in range(y_min, y_min + tile_size):
-                tile[pixel_x % tile_size, pixel_y % tile_size] = self.render_pixel(
-                    pixel_coords=torch.Tensor([pixel_x, pixel_y])
-                    .view(1, 2)
-                    .to(points_in_tile_mean.device),
-                    points_in_tile_mean=points_in_tile_mean,
-                    colors=colors,
-                    opacities=opacities,
-                    inverse_covariance=inverse_covariance,
+                pixel_coords = (
+                    torch.Tensor([pixel_x, pixel_y]).view(1, 2).to(points_in_tile_mean.device)
                 )
+                if mode == "color":
+                    value = self.render_pixel(
+                        pixel_coords=pixel_coords,
+                        points_in_tile_mean=points_in_tile_mean,
+                        colors=colors,
+                        opacities=opacities,
+                        inverse_covariance=inverse_covariance,
+                        stats=stats,
+                    )
+                else:
+                    value = self.render_pixel_depth(
+                        pixel_coords=pixel_coords,
+                        points_in_tile_mean=points_in_tile_mean,
+                        depths=depths,
+                        opacities=opacities,
+                        inverse_covariance=inverse_covariance,
+                        output_depth=(mode == "depth"),
+                        stats=stats,
+                    )
+                tile[pixel_x % tile_size, pixel_y % tile_size] = value
+
+        if stats is not None:
+            # The GPU kernels load the list in batches and only stop between them
+            batches = (stats["walked"] + batch_size - 1) // batch_size
+            tile_stats["visited"] = min(batches * batch_size, point_count)
+            tile_stats["contributed"] = int(stats["contributed"].sum().item())
+            tile_stats["saturated_at"] = stats["saturated_at"] if stats["all_saturated"] else -1
+            tile_stats["list_length"] = point_count
         return tile
 
-    def render_image(self, image_idx: int, tile_size: int = 16) -> torch.Tensor:
-        """For each tile have to check if the point is in the tile"""
+    @staticmethod
+    def _record_contribution(stats: dict, point_idx: int, pixel_coords: torch.Tensor) -> None:
+        # Same definition as the GPU kernels: a blend into a pixel inside the Gaussian's
+        # bounding box, since they skip the pixels outside it. Without bounds any blend counts.
+        if stats is None:
+            return
+        if stats["bounds"] is not None:
+            min_x, max_x, min_y, max_y = stats["bounds"][point_idx].tolist()
+            x, y = pixel_coords[0].tolist()
+            if x < min_x or x > max_x or y < min_y or y > max_y:
+                return
+        stats["contributed"][point_idx] = True
+
+    @staticmethod
+    def _record_saturation(stats: dict, saturated_at: int) -> None:
+        """
+        Records how far down the list a pixel walked: up to saturated_at, or the whole
+        list when it never saturated (None).
+        """
+        if stats is None:
+            return
+        if saturated_at is None:
+            stats["walked"] = stats["contributed"].shape[0]
+            stats["all_saturated"] = False
+        else:
+            stats["walked"] = max(stats["walked"], saturated_at)
+            stats["saturated_at"] = max(stats["saturated_at"], saturated_at)
+
+    def render_image(
+        self,
+        image_idx: int,
+        tile_size: int = 16,
+        mode: str = "color",
+        tile_stats: dict = None,
+        batch_size: int = 256,
+    ) -> torch.Tensor:
+        """
+        For each tile have to check if the point is in the tile.
+        mode is "color", "depth" (expected view-space depth) or "alpha" (accumulated opacity).
+
+        tile_stats, when given (e.g. an empty dict), is filled with the per-tile workload
+        counters of the Vulkan --tile-stats option, as int64 arrays indexed [tile_x, tile_y]:
+        "visited" (list entries loaded before the tile finished, in whole batches of
+        batch_size like the GPU kernels' KernelConfig::batchSize), "contributed" (Gaussians
+        blended into at least one pixel inside their bounding box), "saturated_at" (entries
+        walked when the last pixel saturated, -1 if one never did) and "list_length". Tiles
+        that are not rendered stay zero. Without it nothing is counted. The definitions match
+        the GPU counters, but this renderer saturates at a transmittance of 1e-6 instead of
+        0.001 and does not clamp alpha to 0.99, so pixels walk further before they saturate.
+        """
+        if mode not in ("color", "depth", "alpha"):
+            raise ValueError(f"Unknown render mode: {mode}")
+
         preprocessed_scene = self.preprocess(image_idx)
         height = int(self.images[image_idx].height.item())
         width = int(self.images[image_idx].width.item())
 
-        image = torch.zeros((width, height, 3))
+        channels = 3 if mode == "color" else 1
+        image = torch.zeros((width, height, channels))
+
+        if tile_stats is not None:
+            tiles_shape = ((width + tile_size - 1) // tile_size, (height + tile_size - 1) // tile_size)
+            for key in ("visited", "contributed", "saturated_at", "list_length"):
+                tile_stats[key] = np.zeros(tiles_shape, dtype=np.int64)
 
         for x_min in tqdm(range(0, width - tile_size, tile_size)):
             x_in_tile = (preprocessed_scene.min_x <= x_min + tile_size) & (
@@ -224,10 +375,23 @@ class GaussianScene(nn.Module):
                     continue
                 points_in_tile_mean = preprocessed_scene.points[points_in_tile]
                 colors_in_tile = preprocessed_scene.colors[points_in_tile]
+                depths_in_tile = preprocessed_scene.depths[points_in_tile]
                 opacities_in_tile = preprocessed_scene.sigmoid_opacity[points_in_tile]
                 inverse_covariance_in_tile = preprocessed_scene.inverse_covariance_2d[
                     points_in_tile
                 ]
+                counters = {} if tile_stats is not None else None
+                bounds_in_tile = None
+                if tile_stats is not None:
+                    bounds_in_tile = torch.stack(
+                        [
+                            preprocessed_scene.min_x[points_in_tile],
+                            preprocessed_scene.max_x[points_in_tile],
+                            preprocessed_scene.min_y[points_in_tile],
+                            preprocessed_scene.max_y[points_in_tile],
+                        ],
+                        dim=1,
+                    )
                 image[x_min : x_min + tile_size, y_min : y_min + tile_size] = (
                     self.render_tile(
                         x_min=x_min,
@@ -237,8 +401,16 @@ class GaussianScene(nn.Module):
                         opacities=opacities_in_tile,
                         inverse_covariance=inverse_covariance_in_tile,
                         tile_size=tile_size,
+                        mode=mode,
+                        depths=depths_in_tile,
+                        tile_stats=counters,
+                        bounds=bounds_in_tile,
+                        batch_size=batch_size,
                     )
                 )
+                if counters is not None:
+                    for key, value in counters.items():
+                        tile_stats[key][x_min // tile_size, y_min // tile_size] = value
         return image
     
     def compile_cuda_ext(self):
@@ -5,9 +5,11 @@ def main():
     parser = argparse.ArgumentParser()
     parser.add_argument("--colmap_path", type=str, required=True, help="Path to the COLMAP sparse data directory.")
     parser.add_argument("--image_id", type=int, required=True, help="ID of the image to render.")
+    parser.add_argument("--mode", type=str, default="color", choices=["color", "depth", "alpha"], help="Render color, expected depth or accumulated alpha.")
+    parser.add_argument("--tile_stats", action="store_true", help="Count the per-tile workload and save its heatmaps.")
     args = parser.parse_args()
 
-    render_and_save_image(colmap_path=args.colmap_path, image_idx=args.image_id)
+    render_and_save_image(colmap_path=args.colmap_path, image_idx=args.image_id, mode=args.mode, tile_stats=args.tile_stats)
 
 if __name__ == "__main__":
     main()
@@ -6,6 +6,7 @@ import torch
 
 from gaussian_splatting import GaussianScene
 from gaussian_splatting import Gaussians
+from utils import export_tile_stats
 
 
 def filter_points3D(reconstruction):
@@ -51,7 +52,9 @@ def initialize_scene(colmap_path):
     # Initialize Scene
     return GaussianScene(colmap_path=colmap_path, gaussians=gaussians)
 
-def render_and_save_image(colmap_path: str, image_idx: int, output_path: str = "./output"):
+def render_and_save_image(
+    colmap_path: str, image_idx: int, output_path: str = "./output", mode: str = "color", tile_stats: bool = False
+):
     """
     Renders the image using Gaussian Splatting and saves the output.
 
@@ -59,6 +62,8 @@ def render_and_save_image(colmap_path: str, image_idx: int, output_path: str = "
         colmap_path (str): Path to the COLMAP reconstruction directory.
         image_idx (int): Index of the image to render.
         output_path (str): Directory to save the rendered images.
+        mode (str): "color", or "depth"/"alpha" for a single-channel render.
+        tile_stats (bool): Also count the per-tile workload and save its heatmaps.
     """
 
     os.makedirs(output_path, exist_ok=True)
@@ -68,8 +73,17 @@ def render_and_save_image(colmap_path: str, image_idx: int, output_path: str = "
 
     print(f"Rendering image with ID {image_idx}...")
     with torch.no_grad():
-        rendered_image = scene.render_image(image_idx=image_idx)
-
-    rendered_image_path = os.path.join(output_path, f"rendered_image_{image_idx}.png")
-    plt.imsave(rendered_image_path, rendered_image.cpu().detach().transpose(0, 1) * 255)
+        counters = {} if tile_stats else None
+        rendered_image = scene.render_image(image_idx=image_idx, mode=mode, tile_stats=counters)
+
+    if mode == "color":
+        rendered_image_path = os.path.join(output_path, f"rendered_image_{image_idx}.png")
+        plt.imsave(rendered_image_path, rendered_image.cpu().detach().transpose(0, 1) * 255)
+    else:
+        rendered_image_path = os.path.join(output_path, f"rendered_{mode}_{image_idx}.png")
+        plt.imsave(rendered_image_path, rendered_image[:, :, 0].cpu().detach().transpose(0, 1), cmap="gray")
     print(f"Rendered image saved to {rendered_image_path}")
+
+    if tile_stats:
+        export_tile_stats(counters, os.path.join(output_path, f"tile_stats_{image_idx}"))
+        print(f"Tile heatmaps saved to {output_path}")
@@ -20,4 +20,10 @@ from .scene_utils import (
     compute_gaussian_weight
 )
 
-from .cuda_utils import load_cuda
\ No newline at end of file
+from .cuda_utils import load_cuda
+
+from .export_utils import (
+    export_preprocessed_csv,
+    export_camera_trajectory,
+    export_tile_stats
+)
\ No newline at end of file
@@ -0,0 +1,122 @@
+import matplotlib.pyplot as plt
+import numpy as np
+
+from utils.schema import PreprocessedScene
+
+def export_preprocessed_csv(
+    preprocessed_scene: PreprocessedScene, filename: str, include_depth: bool = True
+) -> None:
+    """
+    Writes a preprocessed scene in the CSV layout read by the Vulkan compute renderer.
+
+    Each row is x, y, r, g, b, ic11, ic12, ic21, ic22, opacity, min_x, max_x, min_y, max_y,
+    followed by the view-space depth when include_depth is set (needed by --mode depth).
+
+    Args:
+        preprocessed_scene (PreprocessedScene): Output of GaussianScene.preprocess (sorted by depth).
+        filename (str): Path of the CSV file to write.
+        include_depth (bool): Whether to append the depth column.
+    """
+    s = preprocessed_scene
+    columns = [
+        s.points_xy,
+        s.colors,
+        s.inverse_covariance_2d.reshape(-1, 4),
+        s.sigmoid_opacity.reshape(-1, 1),
+        s.min_x.reshape(-1, 1),
+        s.max_x.reshape(-1, 1),
+        s.min_y.reshape(-1, 1),
+        s.max_y.reshape(-1, 1),
+    ]
+    if include_depth:
+        columns.append(s.depths.reshape(-1, 1))
+
+    rows = np.concatenate([c.detach().cpu().float().numpy() for c in columns], axis=1)
+    np.savetxt(filename, rows, delimiter=",", fmt="%.6f")
+
+def export_camera_trajectory(images: list, filename: str) -> None:
+    """
+    Writes a camera trajectory for the Vulkan viewer's --trajectory batch mode.
+
+    The file is the "GSTJ" magic, a uint32 version (1) and a uint32 frame count,
+    followed by one camera.bin record per frame: view (mat4), projection (mat4)
+    and image size (ivec2).
+
+    Args:
+        images (list): GaussianImage instances, one per frame, in render order.
+        filename (str): Path of the binary file to write.
+    """
+    # The readers reject empty trajectories
+    if not images:
+        raise ValueError("A camera trajectory needs at least one image")
+    with open(filename, "wb") as f:
+        f.write(b"GSTJ")
+        f.write(np.array([1, len(images)], dtype=np.uint32).tobytes())
+        for image in images:
+            # The transposed torch matrices read back as column-major glm matrices
+            f.write(image.world_view_transform.detach().cpu().numpy().astype(np.float32).tobytes())
+            f.write(image.projection_matrix.detach().cpu().numpy().astype(np.float32).tobytes())
+            size = [int(image.width.item()), int(image.height.item())]
+            f.write(np.array(size, dtype=np.int32).tobytes())
+
+def _tile_heatmap(values: np.ndarray, non_empty: np.ndarray, tile_size: int) -> np.ndarray:
+    # Blue - cyan - green - yellow - red up to the maximum, like the Vulkan heatmaps
+    stops = np.array([[0, 0, 1], [0, 1, 1], [0, 1, 0], [1, 1, 0], [1, 0, 0]], dtype=np.float32)
+    valid = non_empty & (values >= 0)
+    max_value = values[valid].max() if valid.any() else 0
+    t = np.clip(values / max_value, 0.0, 1.0) * 4.0 if max_value > 0 else np.zeros(values.shape)
+    stop = np.minimum(t.astype(np.int64), 3)
+    blend = (t - stop)[..., None]
+    rgb = stops[stop] + (stops[stop + 1] - stops[stop]) * blend
+
+    rgb[~non_empty] = 0.0
+    rgb[non_empty & (values < 0)] = 1.0
+    # [tile_x, tile_y] to rows of pixels
+    return np.repeat(np.repeat(rgb.transpose(1, 0, 2), tile_size, axis=0), tile_size, axis=1)
+
+def export_tile_stats(tile_stats: dict, prefix: str, tile_size: int = 16) -> dict:
+    """
+    Writes the per-tile workload counters of GaussianScene.render_image as heatmaps
+    (prefix_visited.png, prefix_contributed.png, prefix_saturation.png) and prints their
+    mean, p99 and max over the non-empty tiles, like the Vulkan --tile-stats option.
+
+    Empty tiles are black; in the saturation map, tiles that never saturated are white
+    and are left out of its summary.
+
+    The counters have the GPU definitions: visited counts whole loaded batches and
+    contributed only blends inside a Gaussian's bounding box. The CPU renderer saturates
+    at a lower transmittance (1e-6 instead of 0.001, and alpha is not clamped to 0.99),
+    so its visited and saturated_at run higher than the GPU's on the same tile list.
+
+    Args:
+        tile_stats (dict): Counters filled by render_image(..., tile_stats=...).
+        prefix (str): Path prefix of the PNG files.
+        tile_size (int): Tile size the counters were recorded with.
+
+    Returns:
+        dict: {"visited", "contributed", "saturated_at"} -> {"mean", "p99", "max"}, plus
+        "tile_count" and "unsaturated_tiles".
+    """
+    non_empty = tile_stats["list_length"] > 0
+    saturated_at = tile_stats["saturated_at"]
+    summary = {
+        "tile_count": int(non_empty.sum()),
+        "unsaturated_tiles": int((non_empty & (saturated_at < 0)).sum()),
+    }
+
+    for key, name in (("visited", "visited"), ("contributed", "contributed"), ("saturated_at", "saturation")):
+        values = tile_stats[key]
+        selected = np.sort(values[non_empty & (values >= 0)])
+        if selected.size > 0:
+            p99 = selected[(selected.size * 99 + 99) // 100 - 1]
+            summary[key] = {"mean": float(selected.mean()), "p99": int(p99), "max": int(selected[-1])}
+        else:
+            summary[key] = {"mean": 0.0, "p99": 0, "max": 0}
+        plt.imsave(f"{prefix}_{name}.png", _tile_heatmap(values, non_empty, tile_size))
+
+    print(f"Tile statistics over {summary['tile_count']} non-empty tiles:")
+    for key in ("visited", "contributed", "saturated_at"):
+        metric = summary[key]
+        print(f"  {key}: mean {metric['mean']:.2f}, p99 {metric['p99']}, max {metric['max']}")
+    print(f"  {summary['unsaturated_tiles']} tiles with pixels that never saturated")
+    return summary
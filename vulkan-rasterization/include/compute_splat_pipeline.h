@@ -0,0 +1,96 @@
+#pragma once
+#include "vulkan_setup.h"
+#include <vector>
+#include <vulkan/vulkan.h>
+#include <string>
+#include <file_loader.h>
+
+// Viewer mode that runs the compute splatting kernel instead of the point
+// rasterizer. A projection pass turns the 3D Gaussians into screen-space splats,
+// the splat pass blends them into a storage image, and the image is blitted (or,
+// without blit support, copied) to the acquired swapchain image, so nothing is
+// read back to the CPU.
+//
+// For trajectory rendering the same passes run offscreen instead: the pipeline
+// is created once for the largest frame, and each camera is uploaded with
+// updateCamera() and rendered into a host-visible readback buffer.
+class ComputeSplatPipeline {
+public:
+    ComputeSplatPipeline(VulkanSetup &vkSetup);
+    void createPipeline();
+    void createOffscreenPipeline(VkExtent2D maxExtent);
+    void createGaussianBuffer(const std::vector<Gaussian> &gaussians);
+    // Re-uploads the same number of Gaussians, e.g. re-sorted for a new camera
+    void updateGaussians(const std::vector<Gaussian> &gaussians);
+    void createCameraBuffer(CameraBuffer &cameraData);
+    void updateCamera(const CameraBuffer &cameraData);
+    void renderFrame();
+    // Renders the current camera at its image size and returns tightly packed RGBA8 pixels
+    void renderOffscreen(std::vector<uint8_t> &pixels);
+
+    void cleanup();
+
+private:
+    // Matches the Splat struct in project.comp / splat.comp (std430)
+    struct Splat {
+        float position[2];
+        float depth;
+        float opacity;
+        float conic[4];
+        float color[4];
+        float bounds[4];
+    };
+
+    struct PushConstants {
+        int32_t renderWidth;
+        int32_t renderHeight;
+        uint32_t gaussianCount;
+    };
+
+    VulkanSetup &vulkan;
+    VkExtent2D renderExtent;  // Size of the output image
+    VkExtent2D frameExtent;   // Size rendered this frame (<= renderExtent)
+
+    VkPipeline projectPipeline;
+    VkPipeline splatPipeline;
+    VkPipelineLayout projectPipelineLayout;
+    VkPipelineLayout splatPipelineLayout;
+    VkDescriptorSetLayout projectDescriptorSetLayout;
+    VkDescriptorSetLayout splatDescriptorSetLayout;
+    VkDescriptorSet projectDescriptorSet;
+    VkDescriptorSet splatDescriptorSet;
+
+    VkBuffer gaussianBuffer;
+    VkBuffer cameraBuffer;
+    VkBuffer splatBuffer;
+
+    VkImage outputImage;
+    VkImageView outputImageView;
+
+    VkBuffer readbackBuffer = VK_NULL_HANDLE;
+
+    VkCommandBuffer commandBuffer;
+    VkSemaphore imageAvailableSemaphore, renderFinishedSemaphore;
+    VkFence renderFence;
+
+    uint32_t gaussianCount = 0;
+    // False when the swapchain format cannot be blitted to; the image is copied instead
+    bool blitToSwapchain = true;
+    VkBool32 swapRedBlue = VK_FALSE; // splat.comp specialization constant 0
+
+    void createOutputImage();
+    void destroyOutputImage();
+    void createDescriptorSets();
+    void writeOutputImageDescriptor();
+    // Recreates the swapchain and the output image at the new window size
+    void recreateSwapchain();
+    void createComputePipelines();
+    void createSyncObjects();
+    void recordComputePasses();
+    VkPipeline createComputePipeline(const std::string &shaderFile, VkPipelineLayout layout,
+                                     const VkSpecializationInfo *specialization = nullptr);
+    void chooseSwapchainTransfer();
+
+    std::vector<char> readShaderFile(const std::string &filename);
+    VkShaderModule createShaderModule(const std::vector<char> &code);
+};
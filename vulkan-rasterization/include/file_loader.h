@@ -1,6 +1,8 @@
 #pragma once
+#include "camera_trajectory.hpp"
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -21,4 +23,6 @@ class FileLoader {
 public:
     static std::vector<Gaussian> loadGaussianData(const std::string &filename);
     static CameraBuffer loadCameraData(const std::string &cameraFilename);
+    // Also accepts a plain camera.bin as a single-frame trajectory
+    static std::vector<CameraBuffer> loadCameraTrajectory(const std::string &trajectoryFilename);
 };
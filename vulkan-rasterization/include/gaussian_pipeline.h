@@ -26,7 +26,6 @@ private:
     VkPipelineLayout pipelineLayout;
     VkRenderPass renderPass;  
     VkBuffer gaussianBuffer;
-    VkDeviceMemory gaussianBufferMemory;
     
     VkFramebuffer framebuffer;
     VkCommandBuffer commandBuffer;
@@ -38,11 +37,9 @@ private:
     VkDescriptorSetLayout cameraDescriptorSetLayout;  
 
     VkImage depthImage;               
-    VkDeviceMemory depthImageMemory;  
     VkImageView depthImageView;       
 
     VkBuffer cameraBuffer;              
-    VkDeviceMemory cameraBufferMemory;  
     
     uint32_t gaussianCount = 0; 
     
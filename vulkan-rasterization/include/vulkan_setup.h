@@ -1,12 +1,21 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include <GLFW/glfw3.h> 
+#include "memory_arena.hpp"
+#include "pipeline_cache.hpp"
+#include <unordered_map>
 #include <vector>
 
 class VulkanSetup {
 public:
     void initVulkan();
+    // Device, queue, command and descriptor pools only: no window, surface or swapchain,
+    // for offscreen rendering on machines without a display
+    void initHeadless();
     void cleanup();
+    // Replaces the swapchain after a resize (OUT_OF_DATE or SUBOPTIMAL), waiting while the
+    // window is minimized. The device must be idle; the image format stays the same.
+    void recreateSwapchain();
 
     VkDevice getDevice() { return device; }
     VkQueue getGraphicsQueue() { return graphicsQueue; }
@@ -15,9 +24,36 @@ public:
     VkSurfaceKHR getSurface() { return surface; } 
     GLFWwindow* getWindow() { return window; } 
     VkSwapchainKHR getSwapchain() { return swapchain; }  
+    const std::vector<VkImage>& getSwapchainImages() { return swapchainImages; }
+    VkExtent2D getSwapchainExtent() { return swapchainExtent; }
+    VkFormat getSwapchainImageFormat() { return swapchainImageFormat; }
+    VkPhysicalDevice getPhysicalDevice() { return physicalDevice; }
     VkDescriptorPool getDescriptorPool() { return descriptorPool; } 
+    // On-disk pipeline cache; create pipelines through it
+    PipelineCache& getPipelineCache() { return pipelineCache; }
 
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+    // Buffer and image memory is sub-allocated from the memory arena
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                      VkBuffer &buffer);
+    void destroyBuffer(VkBuffer buffer);
+    // Host pointer to a HOST_VISIBLE buffer. Arena blocks stay mapped, so there is no unmap.
+    void* mapBuffer(VkBuffer buffer);
+    // Allocates and binds memory for an image created with optimal tiling
+    void bindImageMemory(VkImage image, VkMemoryPropertyFlags properties);
+    void destroyImage(VkImage image);
+    // One-shot copy on the graphics queue, blocking until it has finished
+    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    // Writes `data` into a buffer with TRANSFER_DST usage through a temporary staging buffer
+    void uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size);
+    // DEVICE_LOCAL buffer (usage + TRANSFER_DST) filled with `data` through a staging buffer
+    void createDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags usage, const void* data, VkBuffer &buffer);
+    // Host-visible transfer destination for readback, HOST_CACHED when available.
+    // Call invalidateBuffer before reading it, since cached memory may not be coherent.
+    void createReadbackBuffer(VkDeviceSize size, VkBuffer &buffer);
+    void invalidateBuffer(VkBuffer buffer);
+
+    MemoryArena::Stats getMemoryStats() const { return memoryArena.getStats(); }
+    void printMemoryStats() const { memoryArena.printStats(); }
 
 private:
     VkInstance instance;
@@ -27,10 +63,19 @@ private:
     VkQueue graphicsQueue;
     VkCommandPool commandPool;
     VkSwapchainKHR swapchain;       
+    std::vector<VkImage> swapchainImages;
+    VkExtent2D swapchainExtent;
+    VkFormat swapchainImageFormat = VK_FORMAT_B8G8R8A8_UNORM;
     VkSurfaceKHR surface;          
     VkImageView swapchainImageView; 
     GLFWwindow* window; 
     VkDescriptorPool descriptorPool; 
+    bool headless = false;
+
+    MemoryArena memoryArena;
+    PipelineCache pipelineCache;
+    std::unordered_map<VkBuffer, MemoryArena::Allocation> bufferAllocations;
+    std::unordered_map<VkImage, MemoryArena::Allocation> imageAllocations;
     
     uint32_t findQueueFamily(VkQueueFlagBits queueFlags);
     
@@ -0,0 +1,698 @@
+#include "compute_splat_pipeline.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <array>
+
+ComputeSplatPipeline::ComputeSplatPipeline(VulkanSetup &vkSetup) : vulkan(vkSetup) {}
+
+std::vector<char> ComputeSplatPipeline::readShaderFile(const std::string &filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open shader file: " + filename);
+    }
+
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+    return buffer;
+}
+
+VkShaderModule ComputeSplatPipeline::createShaderModule(const std::vector<char> &code) {
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(vulkan.getDevice(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shader module!");
+    }
+
+    return shaderModule;
+}
+
+void ComputeSplatPipeline::createGaussianBuffer(const std::vector<Gaussian> &gaussians) {
+    gaussianCount = static_cast<uint32_t>(gaussians.size());
+
+    // Raw Gaussian records, read as a flat float array by project.comp
+    static_assert(sizeof(Gaussian) == 16 * sizeof(float), "project.comp expects 16 floats per Gaussian");
+    VkDeviceSize bufferSize = sizeof(Gaussian) * gaussians.size();
+
+    // Read by project.comp every frame, so it lives in device memory
+    vulkan.createDeviceLocalBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, gaussians.data(),
+                                   gaussianBuffer);
+
+    // Projected splats only ever live on the GPU
+    vulkan.createBuffer(sizeof(Splat) * gaussians.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, splatBuffer);
+}
+
+void ComputeSplatPipeline::updateGaussians(const std::vector<Gaussian> &gaussians) {
+    if (gaussians.size() != gaussianCount) {
+        throw std::runtime_error("Gaussian count does not match the Gaussian buffer!");
+    }
+
+    // Only called between frames; the upload waits for the copy to finish
+    vulkan.uploadBuffer(gaussianBuffer, gaussians.data(), sizeof(Gaussian) * gaussians.size());
+}
+
+void ComputeSplatPipeline::createCameraBuffer(CameraBuffer &cameraData) {
+    std::cout << "Creating camera buffer..." << std::endl;
+
+    VkDeviceSize bufferSize = sizeof(CameraBuffer);
+
+    vulkan.createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                        cameraBuffer);
+
+    memcpy(vulkan.mapBuffer(cameraBuffer), &cameraData, bufferSize);
+}
+
+void ComputeSplatPipeline::updateCamera(const CameraBuffer &cameraData) {
+    if (cameraData.imageSize.x <= 0 || cameraData.imageSize.y <= 0 ||
+        static_cast<uint32_t>(cameraData.imageSize.x) > renderExtent.width ||
+        static_cast<uint32_t>(cameraData.imageSize.y) > renderExtent.height) {
+        throw std::runtime_error("Camera image size does not fit the compute output image!");
+    }
+    frameExtent = {static_cast<uint32_t>(cameraData.imageSize.x), static_cast<uint32_t>(cameraData.imageSize.y)};
+
+    // Only called between frames, the previous submission has already been waited on
+    memcpy(vulkan.mapBuffer(cameraBuffer), &cameraData, sizeof(CameraBuffer));
+}
+
+void ComputeSplatPipeline::createPipeline() {
+    renderExtent = vulkan.getSwapchainExtent();
+    frameExtent = renderExtent;
+    chooseSwapchainTransfer();
+
+    std::cout << "Creating compute output image (" << renderExtent.width << "x" << renderExtent.height << ")..." << std::endl;
+    createOutputImage();
+    std::cout << "Creating compute descriptor sets..." << std::endl;
+    createDescriptorSets();
+    std::cout << "Creating compute pipelines..." << std::endl;
+    createComputePipelines();
+    createSyncObjects();
+}
+
+void ComputeSplatPipeline::createOffscreenPipeline(VkExtent2D maxExtent) {
+    renderExtent = maxExtent;
+    frameExtent = maxExtent;
+
+    std::cout << "Creating offscreen compute output image (" << renderExtent.width << "x" << renderExtent.height << ")..." << std::endl;
+    createOutputImage();
+
+    // Sized for the largest frame, reused for every camera
+    vulkan.createReadbackBuffer(static_cast<VkDeviceSize>(renderExtent.width) * renderExtent.height * 4,
+                                readbackBuffer);
+
+    std::cout << "Creating compute descriptor sets..." << std::endl;
+    createDescriptorSets();
+    std::cout << "Creating compute pipelines..." << std::endl;
+    createComputePipelines();
+    createSyncObjects();
+}
+
+void ComputeSplatPipeline::chooseSwapchainTransfer() {
+    // The blit converts the RGBA8 output image to the swapchain format, but needs blit
+    // support on both formats. Otherwise the image is copied, which only works for a
+    // 32-bit swapchain format: the splat pass then writes the channels in its order.
+    const VkFormat swapchainFormat = vulkan.getSwapchainImageFormat();
+    VkFormatProperties outputProperties, swapchainProperties;
+    vkGetPhysicalDeviceFormatProperties(vulkan.getPhysicalDevice(), VK_FORMAT_R8G8B8A8_UNORM, &outputProperties);
+    vkGetPhysicalDeviceFormatProperties(vulkan.getPhysicalDevice(), swapchainFormat, &swapchainProperties);
+    blitToSwapchain = (outputProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT) &&
+                      (swapchainProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT);
+    if (blitToSwapchain) {
+        return;
+    }
+
+    if (swapchainFormat != VK_FORMAT_B8G8R8A8_UNORM && swapchainFormat != VK_FORMAT_R8G8B8A8_UNORM) {
+        throw std::runtime_error("The compute output image can neither be blitted nor copied to the swapchain!");
+    }
+    swapRedBlue = swapchainFormat == VK_FORMAT_B8G8R8A8_UNORM ? VK_TRUE : VK_FALSE;
+    std::cout << "Swapchain format does not support blits, copying the compute output instead" << std::endl;
+}
+
+void ComputeSplatPipeline::createOutputImage() {
+    const VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    // The splat kernel writes the image, which is then blitted or copied out
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(vulkan.getPhysicalDevice(), format, &formatProperties);
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+        throw std::runtime_error("RGBA8 storage images are not supported on this device!");
+    }
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent.width = renderExtent.width;
+    imageInfo.extent.height = renderExtent.height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(vulkan.getDevice(), &imageInfo, nullptr, &outputImage) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute output image!");
+    }
+
+    vulkan.bindImageMemory(outputImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = outputImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(vulkan.getDevice(), &viewInfo, nullptr, &outputImageView) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute output image view!");
+    }
+}
+
+void ComputeSplatPipeline::destroyOutputImage() {
+    vkDestroyImageView(vulkan.getDevice(), outputImageView, nullptr);
+    vulkan.destroyImage(outputImage);
+}
+
+void ComputeSplatPipeline::writeOutputImageDescriptor() {
+    VkDescriptorImageInfo outputImageInfo{};
+    outputImageInfo.imageView = outputImageView;
+    outputImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = splatDescriptorSet;
+    descriptorWrite.dstBinding = 1;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &outputImageInfo;
+
+    vkUpdateDescriptorSets(vulkan.getDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void ComputeSplatPipeline::recreateSwapchain() {
+    // Nothing may still use the old swapchain or output image
+    vkDeviceWaitIdle(vulkan.getDevice());
+    vulkan.recreateSwapchain();
+
+    destroyOutputImage();
+    renderExtent = vulkan.getSwapchainExtent();
+    frameExtent = renderExtent;
+    std::cout << "Resizing compute output image (" << renderExtent.width << "x" << renderExtent.height << ")..." << std::endl;
+    createOutputImage();
+    writeOutputImageDescriptor();
+}
+
+void ComputeSplatPipeline::createDescriptorSets() {
+    // Projection pass: camera (0), 3D Gaussians (1), splats (2)
+    std::array<VkDescriptorSetLayoutBinding, 3> projectBindings{};
+    projectBindings[0].binding = 0;
+    projectBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    projectBindings[0].descriptorCount = 1;
+    projectBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    projectBindings[1].binding = 1;
+    projectBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    projectBindings[1].descriptorCount = 1;
+    projectBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    projectBindings[2].binding = 2;
+    projectBindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    projectBindings[2].descriptorCount = 1;
+    projectBindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // Splat pass: splats (0), output image (1)
+    std::array<VkDescriptorSetLayoutBinding, 2> splatBindings{};
+    splatBindings[0].binding = 0;
+    splatBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    splatBindings[0].descriptorCount = 1;
+    splatBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    splatBindings[1].binding = 1;
+    splatBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    splatBindings[1].descriptorCount = 1;
+    splatBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(projectBindings.size());
+    layoutInfo.pBindings = projectBindings.data();
+
+    if (vkCreateDescriptorSetLayout(vulkan.getDevice(), &layoutInfo, nullptr, &projectDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create projection descriptor set layout!");
+    }
+
+    layoutInfo.bindingCount = static_cast<uint32_t>(splatBindings.size());
+    layoutInfo.pBindings = splatBindings.data();
+
+    if (vkCreateDescriptorSetLayout(vulkan.getDevice(), &layoutInfo, nullptr, &splatDescriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create splat descriptor set layout!");
+    }
+
+    std::array<VkDescriptorSetLayout, 2> setLayouts = {projectDescriptorSetLayout, splatDescriptorSetLayout};
+    std::array<VkDescriptorSet, 2> sets{};
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = vulkan.getDescriptorPool();
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+    allocInfo.pSetLayouts = setLayouts.data();
+
+    if (vkAllocateDescriptorSets(vulkan.getDevice(), &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate compute descriptor sets!");
+    }
+
+    projectDescriptorSet = sets[0];
+    splatDescriptorSet = sets[1];
+
+    VkDescriptorBufferInfo cameraBufferInfo{};
+    cameraBufferInfo.buffer = cameraBuffer;
+    cameraBufferInfo.offset = 0;
+    cameraBufferInfo.range = sizeof(CameraBuffer);
+
+    VkDescriptorBufferInfo gaussianBufferInfo{};
+    gaussianBufferInfo.buffer = gaussianBuffer;
+    gaussianBufferInfo.offset = 0;
+    gaussianBufferInfo.range = VK_WHOLE_SIZE;
+
+    VkDescriptorBufferInfo splatBufferInfo{};
+    splatBufferInfo.buffer = splatBuffer;
+    splatBufferInfo.offset = 0;
+    splatBufferInfo.range = VK_WHOLE_SIZE;
+
+    std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+
+    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[0].dstSet = projectDescriptorSet;
+    descriptorWrites[0].dstBinding = 0;
+    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptorWrites[0].descriptorCount = 1;
+    descriptorWrites[0].pBufferInfo = &cameraBufferInfo;
+
+    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[1].dstSet = projectDescriptorSet;
+    descriptorWrites[1].dstBinding = 1;
+    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[1].descriptorCount = 1;
+    descriptorWrites[1].pBufferInfo = &gaussianBufferInfo;
+
+    descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[2].dstSet = projectDescriptorSet;
+    descriptorWrites[2].dstBinding = 2;
+    descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[2].descriptorCount = 1;
+    descriptorWrites[2].pBufferInfo = &splatBufferInfo;
+
+    descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[3].dstSet = splatDescriptorSet;
+    descriptorWrites[3].dstBinding = 0;
+    descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[3].descriptorCount = 1;
+    descriptorWrites[3].pBufferInfo = &splatBufferInfo;
+
+    vkUpdateDescriptorSets(vulkan.getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    writeOutputImageDescriptor();
+}
+
+VkPipeline ComputeSplatPipeline::createComputePipeline(const std::string &shaderFile, VkPipelineLayout layout,
+                                                       const VkSpecializationInfo *specialization) {
+    VkShaderModule shaderModule = createShaderModule(readShaderFile(shaderFile));
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = specialization;
+    pipelineInfo.layout = layout;
+
+    VkPipeline pipeline;
+    if (vulkan.getPipelineCache().createComputePipeline(pipelineInfo, pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline: " + shaderFile);
+    }
+
+    vkDestroyShaderModule(vulkan.getDevice(), shaderModule, nullptr);
+    return pipeline;
+}
+
+void ComputeSplatPipeline::createComputePipelines() {
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &projectDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(vulkan.getDevice(), &pipelineLayoutInfo, nullptr, &projectPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create projection pipeline layout!");
+    }
+
+    pipelineLayoutInfo.pSetLayouts = &splatDescriptorSetLayout;
+
+    if (vkCreatePipelineLayout(vulkan.getDevice(), &pipelineLayoutInfo, nullptr, &splatPipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create splat pipeline layout!");
+    }
+
+    projectPipeline = createComputePipeline("../shaders/project.comp.spv", projectPipelineLayout);
+    VkSpecializationMapEntry swapEntry{0, 0, sizeof(VkBool32)};
+    VkSpecializationInfo splatSpecialization{1, &swapEntry, sizeof(VkBool32), &swapRedBlue};
+    splatPipeline = createComputePipeline("../shaders/splat.comp.spv", splatPipelineLayout, &splatSpecialization);
+}
+
+void ComputeSplatPipeline::createSyncObjects() {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = vulkan.getCommandPool();
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(vulkan.getDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate command buffer!");
+    }
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    if (vkCreateSemaphore(vulkan.getDevice(), &semaphoreInfo, nullptr, &imageAvailableSemaphore) != VK_SUCCESS ||
+        vkCreateSemaphore(vulkan.getDevice(), &semaphoreInfo, nullptr, &renderFinishedSemaphore) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create semaphores!");
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;  // Start in signaled state
+
+    if (vkCreateFence(vulkan.getDevice(), &fenceInfo, nullptr, &renderFence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create render fence!");
+    }
+}
+
+void ComputeSplatPipeline::recordComputePasses() {
+    PushConstants pc{static_cast<int32_t>(frameExtent.width), static_cast<int32_t>(frameExtent.height), gaussianCount};
+
+    VkImageSubresourceRange colorRange{};
+    colorRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    colorRange.baseMipLevel = 0;
+    colorRange.levelCount = 1;
+    colorRange.baseArrayLayer = 0;
+    colorRange.layerCount = 1;
+
+    // Output image is fully overwritten every frame, so its old contents can be discarded
+    VkImageMemoryBarrier toGeneral{};
+    toGeneral.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toGeneral.srcAccessMask = 0;
+    toGeneral.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    toGeneral.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toGeneral.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    toGeneral.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toGeneral.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toGeneral.image = outputImage;
+    toGeneral.subresourceRange = colorRange;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &toGeneral);
+
+    // Projection pass, one invocation per Gaussian
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, projectPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, projectPipelineLayout, 0, 1, &projectDescriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, projectPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+    vkCmdDispatch(commandBuffer, (gaussianCount + 255) / 256, 1, 1);
+
+    VkMemoryBarrier splatBarrier{};
+    splatBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    splatBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    splatBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &splatBarrier, 0, nullptr, 0, nullptr);
+
+    // Splat pass, one invocation per pixel (in 16x16 workgroups), each over all splats
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, splatPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, splatPipelineLayout, 0, 1, &splatDescriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, splatPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+    vkCmdDispatch(commandBuffer, (frameExtent.width + 15) / 16, (frameExtent.height + 15) / 16, 1);
+}
+
+void ComputeSplatPipeline::renderFrame() {
+    // Wait for previous frame to finish
+    vkWaitForFences(vulkan.getDevice(), 1, &renderFence, VK_TRUE, UINT64_MAX);
+
+    uint32_t imageIndex;
+    VkSwapchainKHR swapchain = vulkan.getSwapchain();
+
+    VkResult acquireResult = vkAcquireNextImageKHR(
+        vulkan.getDevice(), swapchain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex
+    );
+
+    // The window was resized: nothing was acquired, so skip this frame. A suboptimal
+    // image is still acquired and rendered, the swapchain is replaced after presenting it.
+    if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR) {
+        recreateSwapchain();
+        return;
+    }
+    if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR) {
+        throw std::runtime_error("Failed to acquire swapchain image!");
+    }
+
+    // Only reset once a submission is certain to signal the fence again
+    vkResetFences(vulkan.getDevice(), 1, &renderFence);
+
+    VkImage swapchainImage = vulkan.getSwapchainImages()[imageIndex];
+
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin recording command buffer!");
+    }
+
+    recordComputePasses();
+
+    VkImageSubresourceRange colorRange{};
+    colorRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    colorRange.baseMipLevel = 0;
+    colorRange.levelCount = 1;
+    colorRange.baseArrayLayer = 0;
+    colorRange.layerCount = 1;
+
+    // Output image -> transfer source, swapchain image -> transfer destination
+    std::array<VkImageMemoryBarrier, 2> blitBarriers{};
+    blitBarriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    blitBarriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    blitBarriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    blitBarriers[0].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    blitBarriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    blitBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    blitBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    blitBarriers[0].image = outputImage;
+    blitBarriers[0].subresourceRange = colorRange;
+
+    blitBarriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    blitBarriers[1].srcAccessMask = 0;
+    blitBarriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    blitBarriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    blitBarriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    blitBarriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    blitBarriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    blitBarriers[1].image = swapchainImage;
+    blitBarriers[1].subresourceRange = colorRange;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(blitBarriers.size()), blitBarriers.data());
+
+    if (blitToSwapchain) {
+        // Blit also converts RGBA8 to the swapchain's BGRA8
+        VkImageBlit blitRegion{};
+        blitRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blitRegion.srcSubresource.layerCount = 1;
+        blitRegion.srcOffsets[1] = {static_cast<int32_t>(renderExtent.width), static_cast<int32_t>(renderExtent.height), 1};
+        blitRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blitRegion.dstSubresource.layerCount = 1;
+        blitRegion.dstOffsets[1] = {static_cast<int32_t>(renderExtent.width), static_cast<int32_t>(renderExtent.height), 1};
+
+        vkCmdBlitImage(commandBuffer,
+                       outputImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       swapchainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &blitRegion, VK_FILTER_NEAREST);
+    } else {
+        // Same texel size, the splat pass already wrote the swapchain's channel order
+        VkImageCopy copyRegion{};
+        copyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.srcSubresource.layerCount = 1;
+        copyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.dstSubresource.layerCount = 1;
+        copyRegion.extent = {renderExtent.width, renderExtent.height, 1};
+
+        vkCmdCopyImage(commandBuffer,
+                       outputImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       swapchainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &copyRegion);
+    }
+
+    VkImageMemoryBarrier toPresent{};
+    toPresent.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toPresent.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toPresent.dstAccessMask = 0;
+    toPresent.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toPresent.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    toPresent.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toPresent.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toPresent.image = swapchainImage;
+    toPresent.subresourceRange = colorRange;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &toPresent);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to record command buffer!");
+    }
+
+    // Only the blit has to wait for the swapchain image, the compute passes can start right away
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    VkSemaphore waitSemaphores[] = {imageAvailableSemaphore};
+    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_TRANSFER_BIT};
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = waitSemaphores;
+    submitInfo.pWaitDstStageMask = waitStages;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    VkSemaphore signalSemaphores[] = {renderFinishedSemaphore};
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+
+    if (vkQueueSubmit(vulkan.getGraphicsQueue(), 1, &submitInfo, renderFence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit compute command buffer!");
+    }
+
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &swapchain;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pImageIndices = &imageIndex;
+
+    VkResult presentResult = vkQueuePresentKHR(vulkan.getGraphicsQueue(), &presentInfo);
+    if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR ||
+        acquireResult == VK_SUBOPTIMAL_KHR) {
+        recreateSwapchain();
+    } else if (presentResult != VK_SUCCESS) {
+        throw std::runtime_error("Failed to present swapchain image!");
+    }
+}
+
+void ComputeSplatPipeline::renderOffscreen(std::vector<uint8_t> &pixels) {
+    vkWaitForFences(vulkan.getDevice(), 1, &renderFence, VK_TRUE, UINT64_MAX);
+    vkResetFences(vulkan.getDevice(), 1, &renderFence);
+
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin recording command buffer!");
+    }
+
+    recordComputePasses();
+
+    VkImageMemoryBarrier toTransfer{};
+    toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toTransfer.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    toTransfer.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = outputImage;
+    toTransfer.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    toTransfer.subresourceRange.levelCount = 1;
+    toTransfer.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+    // Only the rendered frame, tightly packed
+    VkBufferImageCopy copyRegion{};
+    copyRegion.bufferOffset = 0;
+    copyRegion.bufferRowLength = 0;
+    copyRegion.bufferImageHeight = 0;
+    copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.imageSubresource.layerCount = 1;
+    copyRegion.imageExtent = {frameExtent.width, frameExtent.height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, outputImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &copyRegion);
+
+    VkMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to record command buffer!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(vulkan.getGraphicsQueue(), 1, &submitInfo, renderFence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit compute command buffer!");
+    }
+
+    vkWaitForFences(vulkan.getDevice(), 1, &renderFence, VK_TRUE, UINT64_MAX);
+
+    size_t frameSize = static_cast<size_t>(frameExtent.width) * frameExtent.height * 4;
+    pixels.resize(frameSize);
+
+    vulkan.invalidateBuffer(readbackBuffer);
+    memcpy(pixels.data(), vulkan.mapBuffer(readbackBuffer), frameSize);
+}
+
+void ComputeSplatPipeline::cleanup() {
+    vkDeviceWaitIdle(vulkan.getDevice());
+
+    vkDestroyFence(vulkan.getDevice(), renderFence, nullptr);
+    vkDestroySemaphore(vulkan.getDevice(), renderFinishedSemaphore, nullptr);
+    vkDestroySemaphore(vulkan.getDevice(), imageAvailableSemaphore, nullptr);
+
+    vkDestroyPipeline(vulkan.getDevice(), splatPipeline, nullptr);
+    vkDestroyPipeline(vulkan.getDevice(), projectPipeline, nullptr);
+    vkDestroyPipelineLayout(vulkan.getDevice(), splatPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(vulkan.getDevice(), projectPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.getDevice(), splatDescriptorSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.getDevice(), projectDescriptorSetLayout, nullptr);
+
+    destroyOutputImage();
+
+    vulkan.destroyBuffer(readbackBuffer);
+    vulkan.destroyBuffer(splatBuffer);
+    vulkan.destroyBuffer(cameraBuffer);
+    vulkan.destroyBuffer(gaussianBuffer);
+}
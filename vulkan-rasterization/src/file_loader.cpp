@@ -2,6 +2,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstring>
 
 std::vector<Gaussian> FileLoader::loadGaussianData(const std::string &filename) {
     std::vector<Gaussian> gaussians;
@@ -42,3 +43,56 @@ CameraBuffer FileLoader::loadCameraData(const std::string &cameraFilename) {
 
     return cameraData;
 }
+
+std::vector<CameraBuffer> FileLoader::loadCameraTrajectory(const std::string &trajectoryFilename) {
+    std::ifstream file(trajectoryFilename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open camera trajectory file: " + trajectoryFilename);
+    }
+    const size_t fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    char magic[4] = {};
+    file.read(magic, sizeof(magic));
+    if (!file || std::memcmp(magic, TRAJECTORY_MAGIC, sizeof(magic)) != 0) {
+        file.close();
+        return {loadCameraData(trajectoryFilename)};
+    }
+
+    uint32_t version = 0;
+    uint32_t frameCount = 0;
+    file.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+    file.read(reinterpret_cast<char*>(&frameCount), sizeof(uint32_t));
+    if (!file) {
+        throw std::runtime_error("Camera trajectory header is truncated: " + trajectoryFilename);
+    }
+    if (version != TRAJECTORY_VERSION) {
+        throw std::runtime_error("Unsupported camera trajectory version: " + std::to_string(version));
+    }
+    // 136-byte camera.bin records; checked before allocating
+    const size_t recordSize = 2 * sizeof(glm::mat4) + sizeof(glm::ivec2);
+    if (frameCount == 0) {
+        throw std::runtime_error("Camera trajectory has no frames: " + trajectoryFilename);
+    }
+    if ((fileSize - TRAJECTORY_HEADER_SIZE) / recordSize < frameCount) {
+        throw std::runtime_error("Camera trajectory file is truncated: " + trajectoryFilename);
+    }
+
+    std::vector<CameraBuffer> cameras(frameCount);
+    for (CameraBuffer &camera : cameras) {
+        file.read(reinterpret_cast<char*>(&camera.view), sizeof(glm::mat4));
+        file.read(reinterpret_cast<char*>(&camera.projection), sizeof(glm::mat4));
+        file.read(reinterpret_cast<char*>(&camera.imageSize), sizeof(glm::ivec2));
+        if (!file) {
+            throw std::runtime_error("Camera trajectory file is truncated: " + trajectoryFilename);
+        }
+        if (camera.imageSize.x <= 0 || camera.imageSize.y <= 0) {
+            throw std::runtime_error("Camera trajectory contains an empty image size");
+        }
+    }
+    file.close();
+
+    std::cout << "Camera trajectory loaded: " << frameCount << " frames" << std::endl;
+
+    return cameras;
+}
@@ -294,7 +294,7 @@ void GaussianPipeline::createPipeline() {
 
     // std::cout << "done until graphicspipeline..." << std::endl;
 
-    if (vkCreateGraphicsPipelines(vulkan.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+    if (vulkan.getPipelineCache().createGraphicsPipeline(pipelineInfo, graphicsPipeline) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create graphics pipeline!");
     }
 
@@ -363,36 +363,9 @@ void GaussianPipeline::createGaussianBuffer(const std::vector<Gaussian> &gaussia
 
     VkDeviceSize bufferSize = sizeof(Gaussian) * gaussians.size();
 
-    // Create Buffer
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = bufferSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(vulkan.getDevice(), &bufferInfo, nullptr, &gaussianBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create Gaussian buffer!");
-    }
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(vulkan.getDevice(), gaussianBuffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = vulkan.findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    if (vkAllocateMemory(vulkan.getDevice(), &allocInfo, nullptr, &gaussianBufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate Gaussian buffer memory!");
-    }
-
-    vkBindBufferMemory(vulkan.getDevice(), gaussianBuffer, gaussianBufferMemory, 0);
-
-    // Upload Gaussian data
-    void* data;
-    vkMapMemory(vulkan.getDevice(), gaussianBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, gaussians.data(), (size_t)bufferSize);
-    vkUnmapMemory(vulkan.getDevice(), gaussianBufferMemory);
+    // Vertex and storage reads every frame, so upload once into device memory
+    vulkan.createDeviceLocalBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                   gaussians.data(), gaussianBuffer);
 
 }
 
@@ -540,7 +513,7 @@ void GaussianPipeline::renderFrame() {
     // std::cout << "First 5 Gaussians (GPU buffer check)" << std::endl;
 
     // void* gpuData;
-    // vkMapMemory(vulkan.getDevice(), gaussianBufferMemory, 0, sizeof(Gaussian) * 5, 0, &gpuData);
+    // gpuData = vulkan.mapBuffer(gaussianBuffer);
     // Gaussian* gpuGaussians = static_cast<Gaussian*>(gpuData);
 
     // for (size_t i = 0; i < 2; i++) {
@@ -572,12 +545,11 @@ void GaussianPipeline::renderFrame() {
     //     std::cout << "  Opacity: " << g.opacity << "\n\n";
     // }
 
-    // vkUnmapMemory(vulkan.getDevice(), gaussianBufferMemory);
 
     // std::cout << "Camera Buffer (GPU Check):" << std::endl;
 
     // void* cameraDataGPU;
-    // vkMapMemory(vulkan.getDevice(), cameraBufferMemory, 0, sizeof(CameraBuffer), 0, &cameraDataGPU);
+    // cameraDataGPU = vulkan.mapBuffer(cameraBuffer);
     // CameraBuffer* gpuCameraBuffer = static_cast<CameraBuffer*>(cameraDataGPU);
 
     // std::cout << "View Matrix:" << std::endl;
@@ -600,7 +572,6 @@ void GaussianPipeline::renderFrame() {
 
     // std::cout << "Image Size: (" << gpuCameraBuffer->imageSize.x << ", " << gpuCameraBuffer->imageSize.y << ")" << std::endl;
 
-    // vkUnmapMemory(vulkan.getDevice(), cameraBufferMemory);
 
     // bind vertex data
     VkDeviceSize offsets[] = {0};
@@ -669,20 +640,8 @@ void GaussianPipeline::createDepthResources() {
         throw std::runtime_error("Failed to create depth image!");
     }
 
-    // Allocate memory for depth image
-    VkMemoryRequirements memRequirements;
-    vkGetImageMemoryRequirements(vulkan.getDevice(), depthImage, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = vulkan.findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-    if (vkAllocateMemory(vulkan.getDevice(), &allocInfo, nullptr, &depthImageMemory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate depth image memory!");
-    }
-
-    vkBindImageMemory(vulkan.getDevice(), depthImage, depthImageMemory, 0);
+    // Depth image memory comes from the device-local arena
+    vulkan.bindImageMemory(depthImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
     // Create depth image view
     VkImageViewCreateInfo viewInfo{};
@@ -706,41 +665,11 @@ void GaussianPipeline::createCameraBuffer(CameraBuffer &cameraData) {
 
     VkDeviceSize bufferSize = sizeof(CameraBuffer);
 
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = bufferSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(vulkan.getDevice(), &bufferInfo, nullptr, &cameraBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create Camera buffer!");
-    }
-
-    // std::cout << "camera buffer memres..." << std::endl;
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(vulkan.getDevice(), cameraBuffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = vulkan.findMemoryType(
-        memRequirements.memoryTypeBits,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    );
-
-    if (vkAllocateMemory(vulkan.getDevice(), &allocInfo, nullptr, &cameraBufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate Camera buffer memory!");
-    }
-    // std::cout << "camera buffer alloced..." << std::endl;
-
-    vkBindBufferMemory(vulkan.getDevice(), cameraBuffer, cameraBufferMemory, 0);
-    // std::cout << "camera buffer bound..." << std::endl;
+    vulkan.createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                        cameraBuffer);
 
     // Upload Camera Data
-    void* data;
-    vkMapMemory(vulkan.getDevice(), cameraBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, &cameraData, bufferSize);
-    vkUnmapMemory(vulkan.getDevice(), cameraBufferMemory);
+    memcpy(vulkan.mapBuffer(cameraBuffer), &cameraData, bufferSize);
     std::cout << "camera data uploaded..." << std::endl;
 }
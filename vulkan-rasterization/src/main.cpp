@@ -1,25 +1,176 @@
 #include "vulkan_setup.h"
 #include "gaussian_pipeline.h"
+#include "compute_splat_pipeline.h"
 #include "file_loader.h"
 #include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
 
-int main() {
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Sorts the Gaussians back to front for one camera, the order splat.comp expects.
+// Gaussians behind the camera are culled by project.comp, so their place does not matter.
+static void sortBackToFront(const std::vector<Gaussian> &gaussians, const CameraBuffer &camera,
+                            std::vector<float> &depths, std::vector<uint32_t> &order, std::vector<Gaussian> &sorted) {
+    depths.resize(gaussians.size());
+    order.resize(gaussians.size());
+    for (size_t i = 0; i < gaussians.size(); ++i) {
+        depths[i] = (camera.view * glm::vec4(gaussians[i].position, 1.0f)).z;
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(order.begin(), order.end(), [&depths](uint32_t a, uint32_t b) { return depths[a] > depths[b]; });
+
+    sorted.resize(gaussians.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        sorted[i] = gaussians[order[i]];
+    }
+}
+
+// Renders every camera of a trajectory offscreen with the compute splatting kernel.
+// The pipeline creation is paid once for the whole job; per frame the scene is
+// re-sorted for the camera and re-uploaded, and project.comp culls it for the view.
+static void renderTrajectory(VulkanSetup &vulkan, const std::vector<Gaussian> &gaussians,
+                             const std::vector<CameraBuffer> &cameras) {
+    if (cameras.empty()) {
+        throw std::runtime_error("Camera trajectory is empty!");
+    }
+
+    // The output image is sized once for the largest frame
+    VkExtent2D maxExtent{0, 0};
+    for (const CameraBuffer &camera : cameras) {
+        maxExtent.width = std::max(maxExtent.width, static_cast<uint32_t>(camera.imageSize.x));
+        maxExtent.height = std::max(maxExtent.height, static_cast<uint32_t>(camera.imageSize.y));
+    }
+
+    auto setupStart = Clock::now();
+    ComputeSplatPipeline pipeline(vulkan);
+    CameraBuffer firstCamera = cameras[0];
+    pipeline.createCameraBuffer(firstCamera);
+    pipeline.createGaussianBuffer(gaussians);
+    pipeline.createOffscreenPipeline(maxExtent);
+    auto setupEnd = Clock::now();
+    std::cout << "Scene upload and pipeline creation: " << elapsedMs(setupStart, setupEnd) << " ms" << std::endl;
+    vulkan.printMemoryStats();
+    vulkan.getPipelineCache().printStats();
+
+    std::vector<uint8_t> pixels;
+    std::vector<float> depths;
+    std::vector<uint32_t> order;
+    std::vector<Gaussian> sorted;
+    double totalSortMs = 0.0;
+    double totalRenderMs = 0.0;
+    for (size_t frame = 0; frame < cameras.size(); ++frame) {
+        const CameraBuffer &camera = cameras[frame];
+
+        auto sortStart = Clock::now();
+        sortBackToFront(gaussians, camera, depths, order, sorted);
+        pipeline.updateGaussians(sorted);
+        auto renderStart = Clock::now();
+        pipeline.updateCamera(camera);
+        pipeline.renderOffscreen(pixels);
+        auto renderEnd = Clock::now();
+
+        char filename[32];
+        std::snprintf(filename, sizeof(filename), "frame_%04zu.png", frame);
+        stbi_write_png(filename, camera.imageSize.x, camera.imageSize.y, 4, pixels.data(), camera.imageSize.x * 4);
+
+        double sortMs = elapsedMs(sortStart, renderStart);
+        double renderMs = elapsedMs(renderStart, renderEnd);
+        totalSortMs += sortMs;
+        totalRenderMs += renderMs;
+        std::cout << "Frame " << frame << " (" << camera.imageSize.x << "x" << camera.imageSize.y << "): sort + upload "
+                  << sortMs << " ms, render " << renderMs << " ms -> " << filename << std::endl;
+    }
+
+    std::cout << "Rendered " << cameras.size() << " frames, average " << totalSortMs / cameras.size()
+              << " ms sort + upload and " << totalRenderMs / cameras.size()
+              << " ms render + readback per frame" << std::endl;
+
+    pipeline.cleanup();
+}
+
+int main(int argc, char** argv) {
+    // --compute switches from the point rasterizer to the compute splatting kernel,
+    // --trajectory <file> renders every camera of the file offscreen and exits,
+    // --scene <file> loads another Gaussian file than the asset culled for camera.bin
+    bool useCompute = false;
+    std::string trajectoryFile;
+    std::string sceneFile = "../assets/sorted_culled_gaussians.bin";
+    bool sceneGiven = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--compute") {
+            useCompute = true;
+        } else if (arg == "--trajectory" && i + 1 < argc) {
+            trajectoryFile = argv[++i];
+        } else if (arg == "--scene" && i + 1 < argc) {
+            sceneFile = argv[++i];
+            sceneGiven = true;
+        }
+    }
+
+    auto startupStart = Clock::now();
     VulkanSetup vulkan;
-    vulkan.initVulkan();
+    // The trajectory batch never presents, so it needs no window or swapchain
+    if (trajectoryFile.empty()) {
+        vulkan.initVulkan();
+    } else {
+        vulkan.initHeadless();
+    }
+
+    std::vector<Gaussian> gaussians = FileLoader::loadGaussianData(sceneFile);
+    std::cout << "Device creation and scene load: " << elapsedMs(startupStart, Clock::now()) << " ms" << std::endl;
+
+    if (!trajectoryFile.empty()) {
+        if (!sceneGiven) {
+            std::cout << "Warning: the default asset is culled for camera.bin, other cameras may miss Gaussians. "
+                         "Pass the unculled scene with --scene." << std::endl;
+        }
+        renderTrajectory(vulkan, gaussians, FileLoader::loadCameraTrajectory(trajectoryFile));
+        vulkan.cleanup();
+        std::cout << "done" << std::endl;
+        return 0;
+    }
 
-    std::vector<Gaussian> gaussians = FileLoader::loadGaussianData("../assets/sorted_culled_gaussians.bin");
     CameraBuffer cameraData = FileLoader::loadCameraData("../assets/camera.bin");
 
-    GaussianPipeline pipeline(vulkan);
-    pipeline.createCameraBuffer(cameraData); 
-    pipeline.createGaussianBuffer(gaussians); 
-    pipeline.createPipeline();
+    if (useCompute) {
+        ComputeSplatPipeline pipeline(vulkan);
+        pipeline.createCameraBuffer(cameraData);
+        pipeline.createGaussianBuffer(gaussians);
+        pipeline.createPipeline();
+        vulkan.getPipelineCache().printStats();
+
+        std::cout << "Rendering frames with the compute splatting kernel..." << std::endl;
+
+        while (!glfwWindowShouldClose(vulkan.getWindow())) {
+            glfwPollEvents();
+            pipeline.renderFrame();
+        }
+
+        pipeline.cleanup();
+    } else {
+        GaussianPipeline pipeline(vulkan);
+        pipeline.createCameraBuffer(cameraData); 
+        pipeline.createGaussianBuffer(gaussians); 
+        pipeline.createPipeline();
+        vulkan.getPipelineCache().printStats();
 
-    std::cout << "Rendering frame..." << std::endl;
+        std::cout << "Rendering frame..." << std::endl;
 
-    while (!glfwWindowShouldClose(vulkan.getWindow())) {
-        glfwPollEvents();  
-        pipeline.renderFrame();  
+        while (!glfwWindowShouldClose(vulkan.getWindow())) {
+            glfwPollEvents();  
+            pipeline.renderFrame();  
+        }
     }
 
     vulkan.cleanup();
@@ -1,6 +1,8 @@
 #include "vulkan_setup.h"
 #include <iostream>
 #include <stdexcept>
+#include <array>
+#include <cstring>
 
 void VulkanSetup::initVulkan() {
     createWindow();    
@@ -8,11 +10,24 @@ void VulkanSetup::initVulkan() {
     createSurface();   
     pickPhysicalDevice();
     createLogicalDevice();
+    memoryArena.init(device, physicalDevice);
+    pipelineCache.init(device, physicalDevice);
     createCommandPool();
     createSwapchain();
     createDescriptorPool(); 
 }
 
+void VulkanSetup::initHeadless() {
+    headless = true;
+    createInstance();
+    pickPhysicalDevice();
+    createLogicalDevice();
+    memoryArena.init(device, physicalDevice);
+    pipelineCache.init(device, physicalDevice);
+    createCommandPool();
+    createDescriptorPool();
+}
+
 
 void VulkanSetup::createInstance() {
     std::cout << "Creating Vulkan instance..." << std::endl;
@@ -25,12 +40,16 @@ void VulkanSetup::createInstance() {
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.apiVersion = VK_API_VERSION_1_2;
 
+    // Headless instances need no surface extensions (and GLFW is never initialized)
     uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    const char** glfwExtensions = nullptr;
+    if (!headless) {
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-    std::cout << "GLFW required extensions:\n";
-    for (uint32_t i = 0; i < glfwExtensionCount; i++) {
-        std::cout << "  - " << glfwExtensions[i] << std::endl;
+        std::cout << "GLFW required extensions:\n";
+        for (uint32_t i = 0; i < glfwExtensionCount; i++) {
+            std::cout << "  - " << glfwExtensions[i] << std::endl;
+        }
     }
 
     const std::vector<const char*> validationLayers = {
@@ -102,9 +121,10 @@ void VulkanSetup::createLogicalDevice() {
     createInfo.pEnabledFeatures = &deviceFeatures;
 
     // Declare the list of required device extensions explicitly
-    std::vector<const char*> deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
+    std::vector<const char*> deviceExtensions;
+    if (!headless) {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
 
     // Correctly set enabled device extensions
     createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
@@ -172,11 +192,12 @@ void VulkanSetup::createSwapchain() {
     swapchainInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
     swapchainInfo.surface = surface;
     swapchainInfo.minImageCount = capabilities.minImageCount + 1;
-    swapchainInfo.imageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+    swapchainInfo.imageFormat = swapchainImageFormat;
     swapchainInfo.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
     swapchainInfo.imageExtent = capabilities.currentExtent;
     swapchainInfo.imageArrayLayers = 1;
-    swapchainInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Transfer destination so the compute viewer can blit into the swapchain images
+    swapchainInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
     uint32_t queueFamilyIndices[] = {findQueueFamily(VK_QUEUE_GRAPHICS_BIT)};
     swapchainInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -191,10 +212,12 @@ void VulkanSetup::createSwapchain() {
         throw std::runtime_error("Failed to create swapchain!");
     }
 
+    swapchainExtent = capabilities.currentExtent;
+
     // Get swapchain images
     uint32_t imageCount;
     vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
-    std::vector<VkImage> swapchainImages(imageCount);
+    swapchainImages.resize(imageCount);
     vkGetSwapchainImagesKHR(device, swapchain, &imageCount, swapchainImages.data());
 
     // Create image view for first swapchain image
@@ -202,7 +225,7 @@ void VulkanSetup::createSwapchain() {
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = swapchainImages[0];
     viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    viewInfo.format = VK_FORMAT_B8G8R8A8_UNORM;
+    viewInfo.format = swapchainImageFormat;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
     viewInfo.subresourceRange.levelCount = 1;
@@ -216,6 +239,20 @@ void VulkanSetup::createSwapchain() {
     std::cout << "Swapchain and ImageView created successfully!" << std::endl;
 }
 
+void VulkanSetup::recreateSwapchain() {
+    // A minimized window has a zero-sized framebuffer, which cannot back a swapchain
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    while (width == 0 || height == 0) {
+        glfwWaitEvents();
+        glfwGetFramebufferSize(window, &width, &height);
+    }
+
+    vkDestroyImageView(device, swapchainImageView, nullptr);
+    vkDestroySwapchainKHR(device, swapchain, nullptr);
+    createSwapchain();
+}
+
 void VulkanSetup::createCommandPool() {
     uint32_t graphicsQueueFamilyIndex = findQueueFamily(VK_QUEUE_GRAPHICS_BIT);
 
@@ -230,39 +267,190 @@ void VulkanSetup::createCommandPool() {
 }
 
 void VulkanSetup::cleanup() {
-    vkDestroyImageView(device, swapchainImageView, nullptr);
-    vkDestroySwapchainKHR(device, swapchain, nullptr);
-    vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (!headless) {
+        vkDestroyImageView(device, swapchainImageView, nullptr);
+        vkDestroySwapchainKHR(device, swapchain, nullptr);
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+    }
     vkDestroyCommandPool(device, commandPool, nullptr);
+    pipelineCache.destroy();
+    memoryArena.destroy();
     vkDestroyDevice(device, nullptr);
     vkDestroyInstance(instance, nullptr);
 
-    glfwDestroyWindow(window);  
-    glfwTerminate();           
+    if (!headless) {
+        glfwDestroyWindow(window);  
+        glfwTerminate();           
+    }
 }
 
-uint32_t VulkanSetup::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+void VulkanSetup::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                               VkBuffer &buffer) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create buffer!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+
+    MemoryArena::Allocation allocation = memoryArena.allocate(memRequirements, properties);
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+    bufferAllocations[buffer] = allocation;
+}
+
+void VulkanSetup::destroyBuffer(VkBuffer buffer) {
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    auto it = bufferAllocations.find(buffer);
+    if (it == bufferAllocations.end()) {
+        throw std::runtime_error("Buffer was not created by VulkanSetup!");
+    }
+
+    vkDestroyBuffer(device, buffer, nullptr);
+    memoryArena.free(it->second);
+    bufferAllocations.erase(it);
+}
+
+void* VulkanSetup::mapBuffer(VkBuffer buffer) {
+    auto it = bufferAllocations.find(buffer);
+    if (it == bufferAllocations.end() || !it->second.mapped) {
+        throw std::runtime_error("Buffer is not host visible!");
+    }
+    return it->second.mapped;
+}
+
+void VulkanSetup::bindImageMemory(VkImage image, VkMemoryPropertyFlags properties) {
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device, image, &memRequirements);
+
+    MemoryArena::Allocation allocation = memoryArena.allocate(memRequirements, properties, false);
+    vkBindImageMemory(device, image, allocation.memory, allocation.offset);
+    imageAllocations[image] = allocation;
+}
+
+void VulkanSetup::destroyImage(VkImage image) {
+    auto it = imageAllocations.find(image);
+    if (it == imageAllocations.end()) {
+        throw std::runtime_error("Image memory was not bound by VulkanSetup!");
+    }
+
+    vkDestroyImage(device, image, nullptr);
+    memoryArena.free(it->second);
+    imageAllocations.erase(it);
+}
+
+void VulkanSetup::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate copy command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+
+    // Uploads are read by shaders and vertex fetch in later submissions, readbacks by the host
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit copy command buffer!");
+    }
+    vkQueueWaitIdle(graphicsQueue);
+
+    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+}
+
+void VulkanSetup::uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size) {
+    VkBuffer stagingBuffer;
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 stagingBuffer);
+
+    memcpy(mapBuffer(stagingBuffer), data, static_cast<size_t>(size));
+
+    copyBuffer(stagingBuffer, dstBuffer, size);
+
+    destroyBuffer(stagingBuffer);
+}
+
+void VulkanSetup::createDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags usage, const void* data,
+                                          VkBuffer &buffer) {
+    createBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer);
+    uploadBuffer(buffer, data, size);
+}
+
+void VulkanSetup::createReadbackBuffer(VkDeviceSize size, VkBuffer &buffer) {
     VkPhysicalDeviceMemoryProperties memProperties;
     vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
 
+    const VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
     for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
+        if ((memProperties.memoryTypes[i].propertyFlags & cached) == cached) {
+            properties = cached;
+            break;
         }
     }
 
-    throw std::runtime_error("Failed to find suitable memory type!");
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, properties, buffer);
+}
+
+void VulkanSetup::invalidateBuffer(VkBuffer buffer) {
+    // Host-visible allocations are aligned and padded to nonCoherentAtomSize by the arena
+    const MemoryArena::Allocation& allocation = bufferAllocations.at(buffer);
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+    range.offset = allocation.offset;
+    range.size = allocation.size;
+    vkInvalidateMappedMemoryRanges(device, 1, &range);
 }
 
 void VulkanSetup::createDescriptorPool() {
-    VkDescriptorPoolSize poolSize{};
-    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSize.descriptorCount = 10; 
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[0].descriptorCount = 10; 
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[1].descriptorCount = 10;
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[2].descriptorCount = 10;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = 1;
-    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
     poolInfo.maxSets = 10; 
 
     if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
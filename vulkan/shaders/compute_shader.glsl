@@ -1,6 +1,12 @@
 #version 450
 
+// Workgroup shape and pixels per invocation are specialization constants
+// (KernelConfig in src/kernel_config.hpp, chosen by --autotune). Each invocation
+// shades PIXELS_PER_THREAD horizontally adjacent pixels, so every Gaussian read
+// from global memory is reused for the whole run.
 layout(local_size_x = 16, local_size_y = 16) in;
+layout(local_size_x_id = 0, local_size_y_id = 1) in;
+layout(constant_id = 2) const uint PIXELS_PER_THREAD = 1;
 
 struct Gaussian {
     float x, y;                 // Point position
@@ -19,7 +25,9 @@ layout(std430, binding = 1) writeonly buffer ImageBuffer {
 };
 
 layout(push_constant) uniform PushConstants {
-    ivec2 imageSize; // Image width and height
+    ivec2 imageSize;    // Image width and height
+    ivec2 regionOffset; // Top-left corner of the render rectangle
+    ivec2 regionSize;   // Width and height of the render rectangle
 };
 
 float compute_pixel_strength(vec2 pixel, vec2 point, mat2 inverse_covariance) {
@@ -29,39 +37,66 @@ float compute_pixel_strength(vec2 pixel, vec2 point, mat2 inverse_covariance) {
 }
 
 void main() {
-    ivec2 pixelPos = ivec2(gl_GlobalInvocationID.xy);
-
-    // Ensure we're within image bounds
-    if (pixelPos.x >= imageSize.x || pixelPos.y >= imageSize.y) return;
-
-    vec2 pixel = vec2(pixelPos);
-    vec3 color = vec3(0.0);
-    float totalWeight = 1.0;
+    ivec2 localPos = ivec2(gl_GlobalInvocationID.x * PIXELS_PER_THREAD, gl_GlobalInvocationID.y);
+
+    // Ensure we're within the render region (which is clamped to the image on the host)
+    if (localPos.x >= regionSize.x || localPos.y >= regionSize.y) return;
+
+    vec2 firstPixel = vec2(regionOffset + localPos);
+    float lastPixelX = firstPixel.x + float(PIXELS_PER_THREAD - 1);
+
+    vec3 color[PIXELS_PER_THREAD];
+    float totalWeight[PIXELS_PER_THREAD];
+    bool done[PIXELS_PER_THREAD];
+    uint activeCount = 0;
+    for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+        color[p] = vec3(0.0);
+        totalWeight[p] = 1.0;
+        // Pixels past the right edge of the region start out finished
+        done[p] = localPos.x + int(p) >= regionSize.x;
+        activeCount += done[p] ? 0u : 1u;
+    }
 
-    for (int i = 0; i < gaussians.length(); ++i) {
+    for (int i = 0; i < gaussians.length() && activeCount > 0; ++i) {
         Gaussian g = gaussians[i];
 
-        // Check if the pixel is within the Gaussian's bounding box
-        if (pixel.x < g.min_x || pixel.x > g.max_x ||
-            pixel.y < g.min_y || pixel.y > g.max_y) {
+        // Check if the invocation's pixel run overlaps the Gaussian's bounding box
+        if (lastPixelX < g.min_x || firstPixel.x > g.max_x ||
+            firstPixel.y < g.min_y || firstPixel.y > g.max_y) {
             continue;
         }
 
-        // Compute strength of the Gaussian at this pixel
         mat2 inverse_covariance = mat2(g.ic11, g.ic12, g.ic21, g.ic22);
-        float strength = compute_pixel_strength(pixel, vec2(g.x, g.y), inverse_covariance);
 
-        float alpha = min(0.99, g.opacity * strength);
-        float weight = totalWeight * (1.0 - alpha);
+        for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+            vec2 pixel = firstPixel + vec2(float(p), 0.0);
+            if (done[p] || pixel.x < g.min_x || pixel.x > g.max_x) {
+                continue;
+            }
+
+            // Compute strength of the Gaussian at this pixel
+            float strength = compute_pixel_strength(pixel, vec2(g.x, g.y), inverse_covariance);
 
-        if (weight < 0.001) break;
+            float alpha = min(0.99, g.opacity * strength);
+            float weight = totalWeight[p] * (1.0 - alpha);
 
-        // Accumulate Gaussian contribution to the pixel color
-        color += totalWeight * alpha * vec3(g.r, g.g, g.b);
-        totalWeight = weight;
+            if (weight < 0.001) {
+                done[p] = true;
+                activeCount--;
+                continue;
+            }
+
+            // Accumulate Gaussian contribution to the pixel color
+            color[p] += totalWeight[p] * alpha * vec3(g.r, g.g, g.b);
+            totalWeight[p] = weight;
+        }
     }
 
-    // Write the color to the image buffer
-    uint index = pixelPos.y * imageSize.x + pixelPos.x;
-    pixels[index] = vec4(color, 1.0); // RGBA
+    // Write the colors to the image buffer, tightly packed to the render region
+    for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+        if (localPos.x + int(p) < regionSize.x) {
+            uint index = localPos.y * regionSize.x + localPos.x + p;
+            pixels[index] = vec4(color[p], 1.0); // RGBA
+        }
+    }
 }
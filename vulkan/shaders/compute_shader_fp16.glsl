@@ -0,0 +1,143 @@
+#version 450
+#ifdef HALF_ARITHMETIC
+#extension GL_EXT_shader_explicit_arithmetic_types_float16 : require
+#extension GL_EXT_shader_16bit_storage : require
+#endif
+
+// Half-precision variant of compute_shader.glsl (--precision half). Gaussians are the
+// 32-byte HalfGaussian records of file_loader.hpp: fp32 position, half-float color,
+// opacity and symmetric conic, and the bounding box as 16-bit whole-pixel bounds.
+// Built twice: as is, the halves are unpacked to fp32 and no device feature is needed;
+// with -DHALF_ARITHMETIC (--precision half-math) they are read through 16-bit storage
+// and each Gaussian is evaluated in fp16. Blending stays in fp32 in both builds.
+
+layout(local_size_x = 16, local_size_y = 16) in;
+layout(local_size_x_id = 0, local_size_y_id = 1) in;
+layout(constant_id = 2) const uint PIXELS_PER_THREAD = 1;
+
+#ifdef HALF_ARITHMETIC
+struct HalfGaussian {
+    vec2 position;          // Point position
+    f16vec2 colorRG;        // Red, green
+    f16vec2 colorBOpacity;  // Blue, opacity
+    f16vec2 conicAB;        // ic11, ic12 + ic21
+    f16vec2 conicC;         // ic22, unused
+    uint boundsX;           // int16 min_x (low half), max_x (high half)
+    uint boundsY;           // int16 min_y, max_y
+};
+#else
+struct HalfGaussian {
+    vec2 position;
+    uint colorRG;           // packHalf2x16 pairs, same order as above
+    uint colorBOpacity;
+    uint conicAB;
+    uint conicC;
+    uint boundsX;
+    uint boundsY;
+};
+#endif
+
+layout(std430, binding = 0) readonly buffer GaussianBuffer {
+    HalfGaussian gaussians[];
+};
+
+layout(std430, binding = 1) writeonly buffer ImageBuffer {
+    vec4 pixels[]; // RGBA output
+};
+
+layout(push_constant) uniform PushConstants {
+    ivec2 imageSize;    // Image width and height
+    ivec2 regionOffset; // Top-left corner of the render rectangle
+    ivec2 regionSize;   // Width and height of the render rectangle
+};
+
+// Sign-extended int16 pair
+ivec2 unpackBounds(uint packed) {
+    return ivec2(bitfieldExtract(int(packed), 0, 16), bitfieldExtract(int(packed), 16, 16));
+}
+
+// Opacity times the Gaussian falloff at `pixel`, before the 0.99 clamp
+float evaluateAlpha(HalfGaussian g, vec2 pixel) {
+#ifdef HALF_ARITHMETIC
+    // (a * dx) * dx keeps the intermediate products inside the fp16 range
+    f16vec2 delta = f16vec2(pixel - g.position);
+    float16_t power = g.conicAB.x * delta.x * delta.x + g.conicAB.y * delta.x * delta.y + g.conicC.x * delta.y * delta.y;
+    return float(g.colorBOpacity.y * exp(float16_t(-0.5) * power));
+#else
+    vec2 conicAB = unpackHalf2x16(g.conicAB);
+    float conicC = unpackHalf2x16(g.conicC).x;
+    vec2 delta = pixel - g.position;
+    float power = conicAB.x * delta.x * delta.x + conicAB.y * delta.x * delta.y + conicC * delta.y * delta.y;
+    return unpackHalf2x16(g.colorBOpacity).y * exp(-0.5 * power);
+#endif
+}
+
+vec3 unpackColor(HalfGaussian g) {
+#ifdef HALF_ARITHMETIC
+    return vec3(vec2(g.colorRG), float(g.colorBOpacity.x));
+#else
+    return vec3(unpackHalf2x16(g.colorRG), unpackHalf2x16(g.colorBOpacity).x);
+#endif
+}
+
+void main() {
+    ivec2 localPos = ivec2(gl_GlobalInvocationID.x * PIXELS_PER_THREAD, gl_GlobalInvocationID.y);
+
+    // Ensure we're within the render region (which is clamped to the image on the host)
+    if (localPos.x >= regionSize.x || localPos.y >= regionSize.y) return;
+
+    ivec2 firstPixel = regionOffset + localPos;
+    int lastPixelX = firstPixel.x + int(PIXELS_PER_THREAD) - 1;
+
+    vec3 color[PIXELS_PER_THREAD];
+    float totalWeight[PIXELS_PER_THREAD];
+    bool done[PIXELS_PER_THREAD];
+    uint activeCount = 0;
+    for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+        color[p] = vec3(0.0);
+        totalWeight[p] = 1.0;
+        // Pixels past the right edge of the region start out finished
+        done[p] = localPos.x + int(p) >= regionSize.x;
+        activeCount += done[p] ? 0u : 1u;
+    }
+
+    for (int i = 0; i < gaussians.length() && activeCount > 0; ++i) {
+        HalfGaussian g = gaussians[i];
+
+        // Whole-pixel bounds give the same test as the fp32 bounding box for integer pixels
+        ivec2 boundsX = unpackBounds(g.boundsX);
+        ivec2 boundsY = unpackBounds(g.boundsY);
+        if (lastPixelX < boundsX.x || firstPixel.x > boundsX.y ||
+            firstPixel.y < boundsY.x || firstPixel.y > boundsY.y) {
+            continue;
+        }
+
+        for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+            int pixelX = firstPixel.x + int(p);
+            if (done[p] || pixelX < boundsX.x || pixelX > boundsX.y) {
+                continue;
+            }
+
+            float alpha = min(0.99, evaluateAlpha(g, vec2(pixelX, firstPixel.y)));
+            float weight = totalWeight[p] * (1.0 - alpha);
+
+            if (weight < 0.001) {
+                done[p] = true;
+                activeCount--;
+                continue;
+            }
+
+            // Accumulate Gaussian contribution to the pixel color
+            color[p] += totalWeight[p] * alpha * unpackColor(g);
+            totalWeight[p] = weight;
+        }
+    }
+
+    // Write the colors to the image buffer, tightly packed to the render region
+    for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+        if (localPos.x + int(p) < regionSize.x) {
+            uint index = localPos.y * regionSize.x + localPos.x + p;
+            pixels[index] = vec4(color[p], 1.0); // RGBA
+        }
+    }
+}
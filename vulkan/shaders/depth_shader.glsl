@@ -0,0 +1,104 @@
+#version 450
+
+// Depth/alpha-only variant of compute_shader.glsl: no color is read or blended,
+// and each pixel writes a single float.
+
+// Same specialization constants as compute_shader.glsl
+layout(local_size_x = 16, local_size_y = 16) in;
+layout(local_size_x_id = 0, local_size_y_id = 1) in;
+layout(constant_id = 2) const uint PIXELS_PER_THREAD = 1;
+
+struct DepthGaussian {
+    float x, y;                      // Point position
+    float conic_a, conic_b, conic_c; // Symmetric inverse covariance (ic11, ic12, ic22)
+    float opacity;                   // Opacity
+    float depth;                     // View-space depth
+    uint boundsX;                    // int16 min_x (low half), max_x (high half)
+    uint boundsY;                    // int16 min_y, max_y
+};
+
+layout(std430, binding = 0) readonly buffer GaussianBuffer {
+    DepthGaussian gaussians[];
+};
+
+layout(std430, binding = 1) writeonly buffer ImageBuffer {
+    float values[]; // Expected depth or accumulated alpha
+};
+
+layout(push_constant) uniform PushConstants {
+    ivec2 imageSize;    // Image width and height
+    ivec2 regionOffset; // Top-left corner of the render rectangle
+    ivec2 regionSize;   // Width and height of the render rectangle
+    int outputDepth;    // 1 = expected depth, 0 = accumulated alpha
+};
+
+// Sign-extended int16 pair
+ivec2 unpackBounds(uint packed) {
+    return ivec2(bitfieldExtract(int(packed), 0, 16), bitfieldExtract(int(packed), 16, 16));
+}
+
+void main() {
+    ivec2 localPos = ivec2(gl_GlobalInvocationID.x * PIXELS_PER_THREAD, gl_GlobalInvocationID.y);
+
+    // Ensure we're within the render region (which is clamped to the image on the host)
+    if (localPos.x >= regionSize.x || localPos.y >= regionSize.y) return;
+
+    ivec2 firstPixel = regionOffset + localPos;
+    int lastPixelX = firstPixel.x + int(PIXELS_PER_THREAD - 1);
+
+    float depth[PIXELS_PER_THREAD];
+    float totalWeight[PIXELS_PER_THREAD];
+    bool done[PIXELS_PER_THREAD];
+    uint activeCount = 0;
+    for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+        depth[p] = 0.0;
+        totalWeight[p] = 1.0;
+        // Pixels past the right edge of the region start out finished
+        done[p] = localPos.x + int(p) >= regionSize.x;
+        activeCount += done[p] ? 0u : 1u;
+    }
+
+    for (int i = 0; i < gaussians.length() && activeCount > 0; ++i) {
+        DepthGaussian g = gaussians[i];
+
+        // Same bounding box test as the color kernels, on whole-pixel bounds
+        ivec2 boundsX = unpackBounds(g.boundsX);
+        ivec2 boundsY = unpackBounds(g.boundsY);
+        if (lastPixelX < boundsX.x || firstPixel.x > boundsX.y ||
+            firstPixel.y < boundsY.x || firstPixel.y > boundsY.y) {
+            continue;
+        }
+
+        for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+            int pixelX = firstPixel.x + int(p);
+            if (done[p] || pixelX < boundsX.x || pixelX > boundsX.y) {
+                continue;
+            }
+
+            vec2 delta = vec2(pixelX, firstPixel.y) - vec2(g.x, g.y);
+            float power = g.conic_a * delta.x * delta.x + 2.0 * g.conic_b * delta.x * delta.y + g.conic_c * delta.y * delta.y;
+
+            float alpha = min(0.99, g.opacity * exp(-0.5 * power));
+            float weight = totalWeight[p] * (1.0 - alpha);
+
+            if (weight < 0.001) {
+                done[p] = true;
+                activeCount--;
+                continue;
+            }
+
+            depth[p] += totalWeight[p] * alpha * g.depth;
+            totalWeight[p] = weight;
+        }
+    }
+
+    // Expected depth is normalized by the accumulated opacity so partially covered
+    // pixels do not fade towards the camera
+    for (uint p = 0; p < PIXELS_PER_THREAD; ++p) {
+        if (localPos.x + int(p) < regionSize.x) {
+            float alpha = 1.0 - totalWeight[p];
+            uint index = localPos.y * regionSize.x + localPos.x + p;
+            values[index] = outputDepth != 0 ? (alpha > 0.0 ? depth[p] / alpha : 0.0) : alpha;
+        }
+    }
+}
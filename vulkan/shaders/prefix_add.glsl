@@ -0,0 +1,26 @@
+#version 450
+
+// Second half of a GpuPrefixSum level: adds the scanned total of all previous
+// blocks to every value of a 512-value block.
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) buffer DataBuffer {
+    uint data[];
+};
+
+layout(std430, binding = 1) readonly buffer BlockSumBuffer {
+    uint blockSums[];
+};
+
+layout(push_constant) uniform PushConstants {
+    uint count;
+};
+
+void main() {
+    uint offset = blockSums[gl_WorkGroupID.x];
+    uint i0 = gl_WorkGroupID.x * 512 + gl_LocalInvocationID.x * 2;
+
+    if (i0 < count) data[i0] += offset;
+    if (i0 + 1 < count) data[i0 + 1] += offset;
+}
@@ -0,0 +1,49 @@
+#version 450
+
+// One level of the exclusive prefix sum (GpuPrefixSum). Each workgroup scans a
+// block of 512 values in place and, if requested, writes the block total so
+// the next level can scan the totals.
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) buffer DataBuffer {
+    uint data[];
+};
+
+layout(std430, binding = 1) writeonly buffer BlockSumBuffer {
+    uint blockSums[];
+};
+
+layout(push_constant) uniform PushConstants {
+    uint count;
+};
+
+shared uint partialSums[256];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    uint i0 = gl_WorkGroupID.x * 512 + lid * 2;
+    uint i1 = i0 + 1;
+
+    uint a = i0 < count ? data[i0] : 0;
+    uint b = i1 < count ? data[i1] : 0;
+    uint threadSum = a + b;
+
+    // Inclusive Hillis-Steele scan over the per-thread sums
+    partialSums[lid] = threadSum;
+    barrier();
+    for (uint offset = 1; offset < 256; offset <<= 1) {
+        uint value = lid >= offset ? partialSums[lid - offset] : 0;
+        barrier();
+        partialSums[lid] += value;
+        barrier();
+    }
+
+    uint exclusive = partialSums[lid] - threadSum;
+    if (i0 < count) data[i0] = exclusive;
+    if (i1 < count) data[i1] = exclusive + a;
+
+    if (lid == 255) {
+        blockSums[gl_WorkGroupID.x] = partialSums[255];
+    }
+}
@@ -0,0 +1,162 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Turns the 3D Gaussians into the preprocessed 2D layout compute_shader.glsl
+// reads, on the device. Mirrors GaussianScene.preprocess: frustum culling,
+// projection to pixels, EWA 2D covariance, inverse covariance, radius and
+// bounds. Culled Gaussians are written with depth 0 and an empty box.
+// The scene is one element of the SceneRegistry's bindless array (set 1), picked
+// by the push constant; outputs past the scene's size are written as culled.
+
+layout(local_size_x = 256) in;
+
+const uint MAX_VIEWS = 64; // GpuPreprocessor::MAX_VIEWS
+
+struct CameraData {
+    mat4 view;
+    mat4 projection;
+    ivec2 imageSize;
+};
+
+// One camera per view of a batched multi-view render, picked by viewIndex
+layout(std140, binding = 0) uniform CameraBuffer {
+    CameraData views[MAX_VIEWS];
+};
+
+// Raw records: position (3), color (3), covariance (9), opacity (1)
+layout(std430, set = 1, binding = 0) readonly buffer SceneBuffer {
+    float sceneData[];
+} scenes[];
+
+struct Gaussian {
+    float x, y;                 // Point position
+    float r, g, b;              // RGB colors
+    float ic11, ic12, ic21, ic22; // Inverse covariance matrix
+    float opacity;              // Opacity
+    float min_x, max_x, min_y, max_y; // Bounding ranges
+};
+
+layout(std430, binding = 1) writeonly buffer GaussianBuffer {
+    Gaussian gaussians[];
+};
+
+// View-space depth per Gaussian, 0 when culled
+layout(std430, binding = 2) writeonly buffer DepthBuffer {
+    float depths[];
+};
+
+layout(push_constant) uniform PushConstants {
+    uint sceneIndex;    // Element of scenes[], uniform across the dispatch
+    uint gaussianCount; // Gaussians in that scene
+    uint outputCount;   // Entries in the output buffers, at least gaussianCount
+    uint viewIndex;     // Element of views[]
+};
+
+const uint FLOATS_PER_GAUSSIAN = 16;
+const float MIN_DEPTH = 0.2; // Same threshold as in_view_frustum
+
+float sceneFloat(uint offset) {
+    return scenes[sceneIndex].sceneData[offset];
+}
+
+void writeCulled(uint index) {
+    Gaussian g;
+    g.x = 0.0; g.y = 0.0;
+    g.r = 0.0; g.g = 0.0; g.b = 0.0;
+    g.ic11 = 0.0; g.ic12 = 0.0; g.ic21 = 0.0; g.ic22 = 0.0;
+    g.opacity = 0.0;
+    g.min_x = 1.0; g.max_x = 0.0; g.min_y = 1.0; g.max_y = 0.0; // empty box, never hit
+    gaussians[index] = g;
+    depths[index] = 0.0;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= outputCount) return;
+    if (index >= gaussianCount) {
+        writeCulled(index);
+        return;
+    }
+
+    CameraData camera = views[viewIndex];
+
+    uint base = index * FLOATS_PER_GAUSSIAN;
+    vec3 position = vec3(sceneFloat(base + 0), sceneFloat(base + 1), sceneFloat(base + 2));
+    vec3 color = vec3(sceneFloat(base + 3), sceneFloat(base + 4), sceneFloat(base + 5));
+    mat3 covariance3d = mat3(
+        sceneFloat(base + 6), sceneFloat(base + 7), sceneFloat(base + 8),
+        sceneFloat(base + 9), sceneFloat(base + 10), sceneFloat(base + 11),
+        sceneFloat(base + 12), sceneFloat(base + 13), sceneFloat(base + 14));
+    float opacity = sceneFloat(base + 15);
+
+    vec4 viewPos = camera.view * vec4(position, 1.0);
+    if (viewPos.z < MIN_DEPTH) {
+        writeCulled(index);
+        return;
+    }
+
+    // NDC to pixel coordinates, see ndc2Pix
+    vec4 clipPos = camera.projection * viewPos;
+    vec2 ndc = clipPos.xy / clipPos.w;
+    vec2 pixel = (ndc + 1.0) * (vec2(camera.imageSize) - 1.0) * 0.5;
+
+    // Focal lengths recovered from the projection matrix
+    float tanFovX = 1.0 / camera.projection[0][0];
+    float tanFovY = 1.0 / camera.projection[1][1];
+    float focalX = float(camera.imageSize.x) / (2.0 * tanFovX);
+    float focalY = float(camera.imageSize.y) / (2.0 * tanFovY);
+
+    // EWA splatting, see compute_2d_covariance
+    float z = viewPos.z;
+    float tx = clamp(viewPos.x / z, -1.3 * tanFovX, 1.3 * tanFovX) * z;
+    float ty = clamp(viewPos.y / z, -1.3 * tanFovY, 1.3 * tanFovY) * z;
+
+    mat3 J = mat3(
+        focalX / z, 0.0, 0.0,
+        0.0, focalY / z, 0.0,
+        -(focalX * tx) / (z * z), -(focalY * ty) / (z * z), 0.0);
+    mat3 W = mat3(camera.view);
+    mat3 T = J * W;
+    mat3 covariance2d = T * covariance3d * transpose(T);
+
+    float a = covariance2d[0][0];
+    float b = covariance2d[0][1];
+    float c = covariance2d[1][1];
+
+    // Inverse covariance, see compute_inverted_covariance
+    float det = a * c - b * b;
+    float clampedDet = max(det, 1e-3);
+
+    // Radius from the largest eigenvalue, see compute_extent_and_radius
+    float mid = 0.5 * (a + c);
+    float lambda = mid + sqrt(max(mid * mid - det, 0.1));
+    float radius = ceil(3.0 * sqrt(lambda));
+
+    vec4 bounds = vec4(floor(pixel.x - radius), ceil(pixel.x + radius),
+                       floor(pixel.y - radius), ceil(pixel.y + radius));
+
+    // Bounding box entirely off screen
+    if (bounds.y < 0.0 || bounds.x > float(camera.imageSize.x - 1) ||
+        bounds.w < 0.0 || bounds.z > float(camera.imageSize.y - 1)) {
+        writeCulled(index);
+        return;
+    }
+
+    Gaussian g;
+    g.x = pixel.x;
+    g.y = pixel.y;
+    g.r = color.r;
+    g.g = color.g;
+    g.b = color.b;
+    g.ic11 = c / clampedDet;
+    g.ic12 = -b / clampedDet;
+    g.ic21 = -b / clampedDet;
+    g.ic22 = a / clampedDet;
+    g.opacity = opacity;
+    g.min_x = bounds.x;
+    g.max_x = bounds.y;
+    g.min_y = bounds.z;
+    g.max_y = bounds.w;
+    gaussians[index] = g;
+    depths[index] = z;
+}
@@ -0,0 +1,49 @@
+#version 450
+
+// Radix sort pass 1: counts the 8-bit digit at `shift` of every key in a block
+// of 1024 keys. Counts are stored digit-major (digit * blockStride + block), so
+// an exclusive scan of the whole array gives every block's output offset per digit.
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) readonly buffer KeyInBuffer {
+    uint keysIn[];
+};
+
+layout(std430, binding = 4) writeonly buffer HistogramBuffer {
+    uint histograms[];
+};
+
+layout(std430, binding = 5) readonly buffer CountBuffer {
+    uint elementCount;
+};
+
+layout(push_constant) uniform PushConstants {
+    uint keyWords;    // 1 for 32-bit keys, 2 for 64-bit keys (low word first)
+    uint word;        // Key word holding the current digit
+    uint shift;       // Bit offset of the digit within that word
+    uint blockStride; // Maximum number of blocks, the stride between digits
+};
+
+const uint ITEMS_PER_INVOCATION = 4;
+const uint BLOCK_SIZE = 256 * ITEMS_PER_INVOCATION;
+
+shared uint localHistogram[256];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    localHistogram[lid] = 0;
+    barrier();
+
+    uint blockStart = gl_WorkGroupID.x * BLOCK_SIZE;
+    for (uint k = 0; k < ITEMS_PER_INVOCATION; ++k) {
+        uint index = blockStart + k * 256 + lid;
+        if (index < elementCount) {
+            uint digit = (keysIn[index * keyWords + word] >> shift) & 0xFF;
+            atomicAdd(localHistogram[digit], 1);
+        }
+    }
+    barrier();
+
+    histograms[lid * blockStride + gl_WorkGroupID.x] = localHistogram[lid];
+}
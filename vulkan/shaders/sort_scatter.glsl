@@ -0,0 +1,99 @@
+#version 450
+
+// Radix sort pass 2: moves every key/value pair of a block to its sorted
+// position for the current digit. The block's base offset per digit comes from
+// the scanned histograms; the rank among equal digits follows the input order,
+// so every pass is stable. Ranks come from one 256-bit mask per digit in shared
+// memory: a key's rank is the number of set bits below its own.
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) readonly buffer KeyInBuffer {
+    uint keysIn[];
+};
+
+layout(std430, binding = 1) readonly buffer ValueInBuffer {
+    uint valuesIn[];
+};
+
+layout(std430, binding = 2) writeonly buffer KeyOutBuffer {
+    uint keysOut[];
+};
+
+layout(std430, binding = 3) writeonly buffer ValueOutBuffer {
+    uint valuesOut[];
+};
+
+layout(std430, binding = 4) readonly buffer HistogramBuffer {
+    uint histograms[];
+};
+
+layout(std430, binding = 5) readonly buffer CountBuffer {
+    uint elementCount;
+};
+
+layout(push_constant) uniform PushConstants {
+    uint keyWords;
+    uint word;
+    uint shift;
+    uint blockStride;
+};
+
+const uint ITEMS_PER_INVOCATION = 4;
+const uint BLOCK_SIZE = 256 * ITEMS_PER_INVOCATION;
+const uint NO_DIGIT = 256;
+
+const uint MASK_WORDS = 256 / 32;
+
+shared uint digitOffsets[256];
+// Bit i of digit d's mask (word d * MASK_WORDS + i / 32) is set when key i of the chunk has digit d
+shared uint digitMasks[256 * MASK_WORDS];
+
+void main() {
+    uint lid = gl_LocalInvocationID.x;
+    digitOffsets[lid] = histograms[lid * blockStride + gl_WorkGroupID.x];
+    barrier();
+
+    // Same 256-key chunks as the histogram pass, in input order
+    uint blockStart = gl_WorkGroupID.x * BLOCK_SIZE;
+    for (uint k = 0; k < ITEMS_PER_INVOCATION; ++k) {
+        uint index = blockStart + k * 256 + lid;
+        bool valid = index < elementCount;
+        uint digit = valid ? (keysIn[index * keyWords + word] >> shift) & 0xFF : NO_DIGIT;
+
+        // Each invocation clears the mask of the digit it owns
+        for (uint w = 0; w < MASK_WORDS; ++w) {
+            digitMasks[lid * MASK_WORDS + w] = 0;
+        }
+        barrier();
+
+        if (valid) {
+            atomicOr(digitMasks[digit * MASK_WORDS + lid / 32], 1u << (lid % 32));
+        }
+        barrier();
+
+        if (valid) {
+            // Keys with the same digit earlier in the chunk
+            uint maskBase = digit * MASK_WORDS;
+            uint rank = uint(bitCount(digitMasks[maskBase + lid / 32] & ((1u << (lid % 32)) - 1u)));
+            for (uint w = 0; w < lid / 32; ++w) {
+                rank += uint(bitCount(digitMasks[maskBase + w]));
+            }
+
+            uint target = digitOffsets[digit] + rank;
+            for (uint w = 0; w < keyWords; ++w) {
+                keysOut[target * keyWords + w] = keysIn[index * keyWords + w];
+            }
+            valuesOut[target] = valuesIn[index];
+        }
+        barrier();
+
+        // Advance the offsets past this chunk once everyone has read them
+        uint chunkCount = 0;
+        for (uint w = 0; w < MASK_WORDS; ++w) {
+            chunkCount += uint(bitCount(digitMasks[lid * MASK_WORDS + w]));
+        }
+        digitOffsets[lid] += chunkCount;
+        barrier();
+    }
+}
@@ -0,0 +1,31 @@
+#version 450
+
+// Turns the element count of a GpuRadixSort run (written on the device) into
+// the workgroup count of the histogram and scatter dispatches.
+
+layout(local_size_x = 1) in;
+
+layout(std430, binding = 5) readonly buffer CountBuffer {
+    uint elementCount;
+};
+
+layout(std430, binding = 6) writeonly buffer DispatchBuffer {
+    uint groupCountX;
+    uint groupCountY;
+    uint groupCountZ;
+};
+
+layout(push_constant) uniform PushConstants {
+    uint keyWords;
+    uint word;
+    uint shift;
+    uint blockStride;
+};
+
+const uint BLOCK_SIZE = 1024; // 256 invocations x 4 keys
+
+void main() {
+    groupCountX = (elementCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    groupCountY = 1;
+    groupCountZ = 1;
+}
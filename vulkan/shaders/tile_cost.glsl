@@ -0,0 +1,41 @@
+#version 450
+
+// GPU tile binning, optional pass 5 (persistent threads): one sort key per active
+// tile from its pair count, so that sorting the active tile list by these keys puts
+// the heaviest tiles first. Keys are maxPairs - count, ascending = heaviest first.
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 5) readonly buffer TileRangeBuffer {
+    uvec2 tileRanges[];
+};
+
+layout(std430, binding = 6) readonly buffer ActiveTileBuffer {
+    uint activeTiles[];
+};
+
+layout(std430, binding = 7) readonly buffer StateBuffer {
+    uint pairCount;
+    uint totalPairs;
+    uint activeTileCount;
+};
+
+layout(std430, binding = 10) writeonly buffer TileCostBuffer {
+    uint tileCostKeys[];
+};
+
+layout(push_constant) uniform PushConstants {
+    ivec2 regionOffset;
+    ivec2 regionSize;
+    uint gaussianCount;
+    uint maxPairs;
+    uint stage;
+};
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= activeTileCount) return;
+
+    uvec2 range = tileRanges[activeTiles[index]];
+    tileCostKeys[index] = maxPairs - min(range.y - range.x, maxPairs);
+}
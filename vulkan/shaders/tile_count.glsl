@@ -0,0 +1,56 @@
+#version 450
+
+// GPU tile binning, pass 1: the number of 16x16 tiles of the render region each
+// preprocessed Gaussian touches (0 when it was culled). An exclusive scan of the
+// counts gives every Gaussian its offset into the tile/Gaussian pair list.
+
+#define TILE_SIZE 16
+
+layout(local_size_x = 256) in;
+
+struct Gaussian {
+    float x, y;                 // Point position
+    float r, g, b;              // RGB colors
+    float ic11, ic12, ic21, ic22; // Inverse covariance matrix
+    float opacity;              // Opacity
+    float min_x, max_x, min_y, max_y; // Bounding ranges
+};
+
+layout(std430, binding = 0) readonly buffer GaussianBuffer {
+    Gaussian gaussians[];
+};
+
+// View-space depth per Gaussian, 0 when culled
+layout(std430, binding = 1) readonly buffer DepthBuffer {
+    float depths[];
+};
+
+layout(std430, binding = 2) writeonly buffer TileCountBuffer {
+    uint tileCounts[];
+};
+
+layout(push_constant) uniform PushConstants {
+    ivec2 regionOffset; // Top-left corner of the render rectangle
+    ivec2 regionSize;   // Width and height of the render rectangle
+    uint gaussianCount;
+    uint maxPairs;      // Capacity of the pair list
+    uint stage;         // tile_setup.glsl only
+};
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= gaussianCount) return;
+
+    uint count = 0;
+    if (depths[index] > 0.0) {
+        // Same tile rectangle as binToTiles on the host, clamped to the grid
+        Gaussian g = gaussians[index];
+        ivec2 tiles = (regionSize + TILE_SIZE - 1) / TILE_SIZE;
+        ivec2 minTile = max(ivec2(floor((vec2(g.min_x, g.min_y) - vec2(regionOffset)) / float(TILE_SIZE))), ivec2(0));
+        ivec2 maxTile = min(ivec2(floor((vec2(g.max_x, g.max_y) - vec2(regionOffset)) / float(TILE_SIZE))), tiles - 1);
+        if (maxTile.x >= minTile.x && maxTile.y >= minTile.y) {
+            count = uint((maxTile.x - minTile.x + 1) * (maxTile.y - minTile.y + 1));
+        }
+    }
+    tileCounts[index] = count;
+}
@@ -0,0 +1,74 @@
+#version 450
+
+// GPU tile binning, pass 2: writes one (tile | depth) key per tile a Gaussian
+// touches, at the Gaussian's scanned offset, with the Gaussian index as value.
+// The tile index is the high word, so sorting the 64-bit keys groups the pairs
+// by tile and orders each tile front to back. Positive depths sort correctly as
+// their raw float bits.
+
+#define TILE_SIZE 16
+
+layout(local_size_x = 256) in;
+
+struct Gaussian {
+    float x, y;                 // Point position
+    float r, g, b;              // RGB colors
+    float ic11, ic12, ic21, ic22; // Inverse covariance matrix
+    float opacity;              // Opacity
+    float min_x, max_x, min_y, max_y; // Bounding ranges
+};
+
+layout(std430, binding = 0) readonly buffer GaussianBuffer {
+    Gaussian gaussians[];
+};
+
+layout(std430, binding = 1) readonly buffer DepthBuffer {
+    float depths[];
+};
+
+// Exclusive scan of tile_count.glsl's output
+layout(std430, binding = 2) readonly buffer TileOffsetBuffer {
+    uint tileOffsets[];
+};
+
+layout(std430, binding = 3) writeonly buffer KeyBuffer {
+    uint keys[]; // Two words per pair: depth bits, tile index
+};
+
+layout(std430, binding = 4) writeonly buffer ValueBuffer {
+    uint values[];
+};
+
+layout(push_constant) uniform PushConstants {
+    ivec2 regionOffset;
+    ivec2 regionSize;
+    uint gaussianCount;
+    uint maxPairs;
+    uint stage;
+};
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= gaussianCount) return;
+
+    float depth = depths[index];
+    if (depth <= 0.0) return;
+
+    Gaussian g = gaussians[index];
+    ivec2 tiles = (regionSize + TILE_SIZE - 1) / TILE_SIZE;
+    ivec2 minTile = max(ivec2(floor((vec2(g.min_x, g.min_y) - vec2(regionOffset)) / float(TILE_SIZE))), ivec2(0));
+    ivec2 maxTile = min(ivec2(floor((vec2(g.max_x, g.max_y) - vec2(regionOffset)) / float(TILE_SIZE))), tiles - 1);
+
+    uint depthBits = floatBitsToUint(depth);
+    uint offset = tileOffsets[index];
+    for (int ty = minTile.y; ty <= maxTile.y; ++ty) {
+        for (int tx = minTile.x; tx <= maxTile.x; ++tx) {
+            // Pairs past the capacity are dropped (reported by GpuTileBinner::readStats)
+            if (offset >= maxPairs) return;
+            keys[offset * 2 + 0] = depthBits;
+            keys[offset * 2 + 1] = uint(ty * tiles.x + tx);
+            values[offset] = index;
+            ++offset;
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#version 450
+
+// GPU tile binning, pass 3: after the sort, the pairs of a tile are contiguous.
+// Each pair that starts or ends a run of equal tile indices writes that tile's
+// [start, end) range, and every non-empty tile is appended to the active tile
+// list the splatting dispatch walks.
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 3) readonly buffer KeyBuffer {
+    uint keys[];
+};
+
+layout(std430, binding = 5) buffer TileRangeBuffer {
+    uvec2 tileRanges[];
+};
+
+layout(std430, binding = 6) writeonly buffer ActiveTileBuffer {
+    uint activeTiles[];
+};
+
+layout(std430, binding = 7) buffer StateBuffer {
+    uint pairCount;       // Pairs in the list, at most maxPairs
+    uint totalPairs;      // Pairs requested by all Gaussians
+    uint activeTileCount; // Tiles with at least one pair
+};
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= pairCount) return;
+
+    uint tile = keys[index * 2 + 1];
+    if (index == 0 || keys[(index - 1) * 2 + 1] != tile) {
+        tileRanges[tile].x = index;
+        activeTiles[atomicAdd(activeTileCount, 1)] = tile;
+    }
+    if (index == pairCount - 1 || keys[(index + 1) * 2 + 1] != tile) {
+        tileRanges[tile].y = index + 1;
+    }
+}
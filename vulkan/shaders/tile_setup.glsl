@@ -0,0 +1,50 @@
+#version 450
+
+// Single-invocation bookkeeping between the GPU tile binning passes, so the host
+// never reads back a count. Stage 0 (after the scan of the tile counts) clamps
+// the pair count to the capacity and sizes the tile_ranges.glsl dispatch;
+// stage 1 (after tile_ranges.glsl) sizes the splatting dispatch, one workgroup
+// per active tile, and the persistent-threads dispatch, capped at the active tiles.
+
+layout(local_size_x = 1) in;
+
+layout(std430, binding = 7) buffer StateBuffer {
+    uint pairCount;
+    uint totalPairs;
+    uint activeTileCount;
+};
+
+struct DispatchCommand {
+    uint x, y, z;
+};
+
+// [0] tile_ranges.glsl, [1] tile_shader.glsl, [2] tile_shader.glsl with persistent threads
+layout(std430, binding = 8) writeonly buffer DispatchBuffer {
+    DispatchCommand dispatches[3];
+};
+
+// Total of the tile count scan
+layout(std430, binding = 9) readonly buffer TotalBuffer {
+    uint scannedTotal;
+};
+
+layout(push_constant) uniform PushConstants {
+    ivec2 regionOffset;
+    ivec2 regionSize;
+    uint gaussianCount;
+    uint maxPairs;
+    uint stage;
+    uint persistentGroups; // Workgroups of the persistent launch
+};
+
+void main() {
+    if (stage == 0) {
+        totalPairs = scannedTotal;
+        pairCount = min(scannedTotal, maxPairs);
+        dispatches[0] = DispatchCommand((pairCount + 255u) / 256u, 1u, 1u);
+    } else {
+        dispatches[1] = DispatchCommand(activeTileCount, 1u, 1u);
+        // At least one workgroup, which finds the queue empty
+        dispatches[2] = DispatchCommand(max(min(activeTileCount, persistentGroups), 1u), 1u, 1u);
+    }
+}
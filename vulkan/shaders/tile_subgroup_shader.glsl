@@ -0,0 +1,275 @@
+#version 450
+#extension GL_KHR_shader_subgroup_basic : require
+#extension GL_KHR_shader_subgroup_vote : require
+#extension GL_KHR_shader_subgroup_ballot : require
+#extension GL_KHR_shader_subgroup_arithmetic : require
+
+// Subgroup variant of tile_shader.glsl (--kernel subgroup), with the same bindings,
+// batching and output. Within a shared-memory batch each subgroup:
+// - stops walking the batch as soon as all of its pixels have saturated (subgroupAll),
+//   instead of waiting for the slowest pixel of the tile;
+// - tests the batch one subgroup-sized chunk at a time against the rectangle of its
+//   unfinished pixels, one Gaussian per lane, and ballots the hits. Chunks missing the
+//   whole subgroup are skipped at once, and only the hit Gaussians are blended.
+
+#define TILE_SIZE 16
+#define THREAD_COUNT (TILE_SIZE * TILE_SIZE)
+
+layout(constant_id = 3) const uint BATCH_SIZE = 256u; // Defaults to THREAD_COUNT, one load per invocation
+
+// Persistent threads (--persistent): a fixed number of workgroups pull tiles from the
+// queue below, heaviest first, instead of one workgroup per tile
+layout(constant_id = 4) const bool PERSISTENT = false;
+
+// Per-tile workload counters (--tile-stats). Off by default; the counting code below is
+// then specialized away.
+layout(constant_id = 5) const bool TILE_STATS = false;
+
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+struct Gaussian {
+    float x, y;                 // Point position
+    float r, g, b;              // RGB colors
+    float ic11, ic12, ic21, ic22; // Inverse covariance matrix
+    float opacity;              // Opacity
+    float min_x, max_x, min_y, max_y; // Bounding ranges
+};
+
+layout(std430, binding = 0) readonly buffer GaussianBuffer {
+    Gaussian gaussians[];
+};
+
+layout(std430, binding = 1) writeonly buffer ImageBuffer {
+    vec4 pixels[]; // RGBA output
+};
+
+// Gaussian indices grouped by tile, depth order preserved within a tile
+layout(std430, binding = 2) readonly buffer TileGaussianBuffer {
+    uint tileGaussians[];
+};
+
+// [start, end) into tileGaussians for every tile of the render region
+layout(std430, binding = 3) readonly buffer TileRangeBuffer {
+    uvec2 tileRanges[];
+};
+
+// Tiles with at least one Gaussian, one workgroup each. Empty tiles are cleared
+// by the host before the dispatch.
+layout(std430, binding = 4) readonly buffer ActiveTileBuffer {
+    uint activeTiles[];
+};
+
+// Work queue of the persistent mode, reset before every dispatch
+layout(std430, binding = 5) buffer TileQueueBuffer {
+    uint queuedTileCount; // Entries of activeTiles to render
+    uint nextQueuedTile;  // Next entry to hand out
+};
+
+// --tile-stats counters, one entry per tile of the render region, cleared before every dispatch
+struct TileStats {
+    uint visited;     // List entries loaded before the tile finished
+    uint contributed; // Gaussians blended into at least one pixel
+    uint saturatedAt; // List entries walked when the last pixel saturated, 0xffffffff if one never did
+    uint listLength;  // Entries in the tile's list
+};
+
+layout(std430, binding = 6) writeonly buffer TileStatsBuffer {
+    TileStats tileStats[];
+};
+
+layout(push_constant) uniform PushConstants {
+    ivec2 imageSize;    // Image width and height
+    ivec2 regionOffset; // Top-left corner of the render rectangle
+    ivec2 regionSize;   // Width and height of the render rectangle
+};
+
+shared vec2 batchPosition[BATCH_SIZE];
+shared vec4 batchConicOpacity[BATCH_SIZE]; // ic11, ic12 + ic21, ic22, opacity
+shared vec3 batchColor[BATCH_SIZE];
+shared vec4 batchBounds[BATCH_SIZE];
+shared uint doneCount;
+shared uint queueEntryShared;
+
+// --tile-stats: one bit per Gaussian of the batch that contributed to a pixel
+#define CONTRIBUTED_WORDS ((BATCH_SIZE + 31u) / 32u)
+shared uint batchContributed[CONTRIBUTED_WORDS];
+shared uint contributedCount;
+shared uint saturatedAt;
+
+void renderTile(uint tileIndex) {
+    uint tilesX = uint((regionSize.x + TILE_SIZE - 1) / TILE_SIZE);
+    ivec2 tile = ivec2(tileIndex % tilesX, tileIndex / tilesX);
+
+    ivec2 localPos = tile * TILE_SIZE + ivec2(gl_LocalInvocationID.xy);
+    bool inside = localPos.x < regionSize.x && localPos.y < regionSize.y;
+
+    vec2 pixel = vec2(regionOffset + localPos);
+    vec3 color = vec3(0.0);
+    float totalWeight = 1.0;
+
+    uvec2 range = tileRanges[tileIndex];
+
+    if (gl_LocalInvocationIndex == 0) {
+        doneCount = 0;
+        if (TILE_STATS) {
+            contributedCount = 0;
+            saturatedAt = 0;
+        }
+    }
+    if (TILE_STATS) {
+        for (uint word = gl_LocalInvocationIndex; word < CONTRIBUTED_WORDS; word += THREAD_COUNT) {
+            batchContributed[word] = 0;
+        }
+    }
+    memoryBarrierShared();
+    barrier();
+    uint visited = 0; // Same in every invocation
+
+    // Invocations past the region edge only help with loading
+    bool done = !inside;
+    if (done) {
+        atomicAdd(doneCount, 1);
+    }
+
+    for (uint batchStart = range.x; batchStart < range.y; batchStart += BATCH_SIZE) {
+        // Also keeps the previous batch alive until every invocation is done with it
+        memoryBarrierShared();
+        barrier();
+        if (doneCount == THREAD_COUNT) {
+            break;
+        }
+
+        // Count the previous batch's contributors before its flags are cleared for this one
+        if (TILE_STATS) {
+            for (uint word = gl_LocalInvocationIndex; word < CONTRIBUTED_WORDS; word += THREAD_COUNT) {
+                atomicAdd(contributedCount, uint(bitCount(batchContributed[word])));
+                batchContributed[word] = 0;
+            }
+            visited = min(batchStart + BATCH_SIZE, range.y) - range.x;
+        }
+
+        // Batches larger than the workgroup take several loads per invocation
+        for (uint slot = gl_LocalInvocationIndex; slot < BATCH_SIZE; slot += THREAD_COUNT) {
+            uint loadIndex = batchStart + slot;
+            if (loadIndex < range.y) {
+                Gaussian g = gaussians[tileGaussians[loadIndex]];
+                batchPosition[slot] = vec2(g.x, g.y);
+                batchConicOpacity[slot] = vec4(g.ic11, g.ic12 + g.ic21, g.ic22, g.opacity);
+                batchColor[slot] = vec3(g.r, g.g, g.b);
+                batchBounds[slot] = vec4(g.min_x, g.max_x, g.min_y, g.max_y);
+            }
+        }
+        memoryBarrierShared();
+        barrier();
+
+        // Finished invocations stay active: every lane has to take part in the chunk ballots
+
+        uint batchCount = min(BATCH_SIZE, range.y - batchStart);
+
+        // Pixel rectangle of the subgroup's unfinished invocations
+        vec2 subgroupMinPixel = subgroupMin(done ? vec2(1e30) : pixel);
+        vec2 subgroupMaxPixel = subgroupMax(done ? vec2(-1e30) : pixel);
+
+        for (uint chunkStart = 0; chunkStart < batchCount; chunkStart += gl_SubgroupSize) {
+            if (subgroupAll(done)) {
+                break;
+            }
+
+            // Each lane tests one Gaussian of the chunk against the whole subgroup
+            uint candidate = chunkStart + gl_SubgroupInvocationID;
+            bool overlaps = false;
+            if (candidate < batchCount) {
+                vec4 bounds = batchBounds[candidate];
+                overlaps = subgroupMaxPixel.x >= bounds.x && subgroupMinPixel.x <= bounds.y &&
+                           subgroupMaxPixel.y >= bounds.z && subgroupMinPixel.y <= bounds.w;
+            }
+            uvec4 hits = subgroupBallot(overlaps);
+
+            // Blend the hit Gaussians in depth order (lowest lane first)
+            while (subgroupBallotBitCount(hits) > 0) {
+                uint lane = subgroupBallotFindLSB(hits);
+                hits[lane / 32] &= ~(1u << (lane % 32));
+                uint i = chunkStart + lane;
+
+                vec4 bounds = batchBounds[i];
+
+                // Check if the pixel is within the Gaussian's bounding box
+                if (done || pixel.x < bounds.x || pixel.x > bounds.y ||
+                    pixel.y < bounds.z || pixel.y > bounds.w) {
+                    continue;
+                }
+
+                // Same expansion of delta^T * inverse_covariance * delta as compute_shader.glsl
+                vec2 delta = pixel - batchPosition[i];
+                vec4 conicOpacity = batchConicOpacity[i];
+                float power = conicOpacity.x * delta.x * delta.x + conicOpacity.y * delta.x * delta.y + conicOpacity.z * delta.y * delta.y;
+                float strength = exp(-0.5 * power);
+
+                float alpha = min(0.99, conicOpacity.w * strength);
+                float weight = totalWeight * (1.0 - alpha);
+
+                if (weight < 0.001) {
+                    done = true;
+                    atomicAdd(doneCount, 1);
+                    if (TILE_STATS) {
+                        atomicMax(saturatedAt, batchStart + i - range.x + 1);
+                    }
+                    continue;
+                }
+
+                // Accumulate Gaussian contribution to the pixel color
+                color += totalWeight * alpha * batchColor[i];
+                totalWeight = weight;
+                if (TILE_STATS) {
+                    atomicOr(batchContributed[i / 32u], 1u << (i % 32u));
+                }
+            }
+        }
+    }
+
+    // The last batch's contributors, and pixels that never saturated
+    if (TILE_STATS) {
+        memoryBarrierShared();
+        barrier();
+        if (!done) {
+            atomicMax(saturatedAt, 0xffffffffu);
+        }
+        for (uint word = gl_LocalInvocationIndex; word < CONTRIBUTED_WORDS; word += THREAD_COUNT) {
+            atomicAdd(contributedCount, uint(bitCount(batchContributed[word])));
+        }
+        memoryBarrierShared();
+        barrier();
+        if (gl_LocalInvocationIndex == 0) {
+            tileStats[tileIndex] = TileStats(visited, contributedCount, saturatedAt, range.y - range.x);
+        }
+    }
+
+    if (!inside) return;
+
+    // Write the color to the image buffer, tightly packed to the render region
+    uint index = localPos.y * regionSize.x + localPos.x;
+    pixels[index] = vec4(color, 1.0); // RGBA
+}
+
+void main() {
+    if (!PERSISTENT) {
+        renderTile(activeTiles[gl_WorkGroupID.x]);
+        return;
+    }
+
+    for (;;) {
+        // Every invocation has finished the previous tile (and read queueEntryShared) past this point
+        barrier();
+        if (gl_LocalInvocationIndex == 0) {
+            queueEntryShared = atomicAdd(nextQueuedTile, 1);
+        }
+        memoryBarrierShared();
+        barrier();
+
+        uint queueEntry = queueEntryShared;
+        if (queueEntry >= queuedTileCount) {
+            break;
+        }
+        renderTile(activeTiles[queueEntry]);
+    }
+}
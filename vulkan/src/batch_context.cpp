@@ -0,0 +1,203 @@
+#include "batch_context.hpp"
+#include <array>
+#include <stdexcept>
+
+BatchContext::BatchContext(VulkanSetup& vulkan, uint32_t slotCount, bool tiled, uint32_t pushConstantSize,
+                           const SlotBufferSizes& slotBufferSizes)
+    : vulkan(vulkan), slotCount(slotCount), tiled(tiled), slotBufferSizes(slotBufferSizes), bufferPool(vulkan) {
+    createLayouts(pushConstantSize);
+    splatTimeline = vulkan.createTimelineSemaphore();
+    copyTimeline = vulkan.createTimelineSemaphore();
+}
+
+BatchContext::~BatchContext() {
+    vkDeviceWaitIdle(vulkan.device);
+
+    for (VkFence fence : fences) {
+        vkDestroyFence(vulkan.device, fence, nullptr);
+    }
+    if (!commandBuffers.empty()) {
+        vkFreeCommandBuffers(vulkan.device, vulkan.commandPool, commandBuffers.size(), commandBuffers.data());
+        vkFreeCommandBuffers(vulkan.device, vulkan.transferCommandPool, transferCommandBuffers.size(),
+                             transferCommandBuffers.data());
+    }
+    vkDestroySemaphore(vulkan.device, copyTimeline, nullptr);
+    vkDestroySemaphore(vulkan.device, splatTimeline, nullptr);
+
+    if (pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(vulkan.device, pipeline, nullptr);
+    }
+    vkDestroyPipelineLayout(vulkan.device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(vulkan.device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.device, descriptorSetLayout, nullptr);
+
+    for (VkBuffer buffer : adoptedBuffers) {
+        vulkan.destroyBuffer(buffer);
+    }
+}
+
+void BatchContext::createLayouts(uint32_t pushConstantSize) {
+    // Gaussians (0) and image (1). Tiled kernels: per-tile Gaussian indices (2), ranges (3),
+    // non-empty tiles (4), the persistent-threads work queue (5) and the --tile-stats counters (6)
+    std::vector<VkDescriptorSetLayoutBinding> bindings(tiled ? 7 : 2);
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor set layout!");
+    }
+
+    // One set per frame slot
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = static_cast<uint32_t>(bindings.size()) * slotCount;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = slotCount;
+
+    if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor pool!");
+    }
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = pushConstantSize;
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(vulkan.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+}
+
+void BatchContext::initSlot(BatchSlot& slot, const SharedBuffers& shared) {
+    if (fences.size() >= slotCount) {
+        throw std::runtime_error("The batch context has no more frame slots!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(vulkan.device, &allocInfo, &slot.descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate descriptor set!");
+    }
+
+    VkCommandBufferAllocateInfo commandInfo = {};
+    commandInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandInfo.commandPool = vulkan.commandPool;
+    commandInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(vulkan.device, &commandInfo, &slot.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate command buffers!");
+    }
+    commandBuffers.push_back(slot.commandBuffer);
+
+    commandInfo.commandPool = vulkan.transferCommandPool;
+    if (vkAllocateCommandBuffers(vulkan.device, &commandInfo, &slot.transferCommandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate transfer command buffers!");
+    }
+    transferCommandBuffers.push_back(slot.transferCommandBuffer);
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(vulkan.device, &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create frame slot fence!");
+    }
+    fences.push_back(slot.fence);
+
+    // The slot's own buffers (1, 5, 6) are bound by acquireSlotBuffers
+    const std::array<uint32_t, 4> sharedBindings = {0, 2, 3, 4};
+    const std::array<VkDescriptorBufferInfo, 4> bufferInfos = {shared.gaussians, shared.tileGaussians, shared.tileRanges,
+                                                               shared.activeTiles};
+    std::array<VkWriteDescriptorSet, 4> descriptorWrites = {};
+    for (uint32_t i = 0; i < descriptorWrites.size(); ++i) {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = slot.descriptorSet;
+        descriptorWrites[i].dstBinding = sharedBindings[i];
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(vulkan.device, tiled ? 4 : 1, descriptorWrites.data(), 0, nullptr);
+}
+
+void BatchContext::acquireSlotBuffers(BatchSlot& slot, uint64_t value) {
+    std::array<VkDescriptorBufferInfo, 3> bufferInfos = {};
+    std::array<VkWriteDescriptorSet, 3> descriptorWrites = {};
+    uint32_t writeCount = 0;
+    auto bind = [&](uint32_t binding, VkBuffer& slotBuffer, VkBuffer buffer, VkDeviceSize range) {
+        if (buffer == slotBuffer) {
+            return;
+        }
+        slotBuffer = buffer;
+        bufferInfos[writeCount] = {buffer, 0, range};
+        VkWriteDescriptorSet& write = descriptorWrites[writeCount];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = slot.descriptorSet;
+        write.dstBinding = binding;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &bufferInfos[writeCount];
+        ++writeCount;
+    };
+
+    // Transfer destination so the tiled kernel can clear the tiles it skips, and transfer
+    // source for the copy into the slot's readback buffer (possibly on the transfer queue)
+    bind(1, slot.imageBuffer, bufferPool.acquire(slotBufferSizes.image,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, value, true), slotBufferSizes.image);
+    slot.readbackBuffer = bufferPool.acquireReadback(slotBufferSizes.readback, value);
+    if (tiled) {
+        bind(5, slot.tileQueueBuffer, bufferPool.acquire(2 * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            value), VK_WHOLE_SIZE);
+        // Written by the kernel and read by the host, too small to be worth a readback copy
+        if (slotBufferSizes.hostVisibleTileStats) {
+            bind(6, slot.tileStatsBuffer, bufferPool.acquire(slotBufferSizes.tileStats,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, value), VK_WHOLE_SIZE);
+        } else {
+            bind(6, slot.tileStatsBuffer, bufferPool.acquire(slotBufferSizes.tileStats, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, value), VK_WHOLE_SIZE);
+        }
+    }
+
+    if (writeCount > 0) {
+        vkUpdateDescriptorSets(vulkan.device, writeCount, descriptorWrites.data(), 0, nullptr);
+    }
+}
+
+void BatchContext::setPipeline(VkPipeline newPipeline) {
+    if (pipeline != VK_NULL_HANDLE && pipeline != newPipeline) {
+        vkDestroyPipeline(vulkan.device, pipeline, nullptr);
+    }
+    pipeline = newPipeline;
+}
+
+void BatchContext::adoptBuffer(VkBuffer buffer) {
+    adoptedBuffers.push_back(buffer);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include "transient_buffer_pool.hpp"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Vulkan objects of one frame slot of a BatchContext. The buffers are those the pool
+// handed out for the slot's frame in flight, see BatchContext::acquireSlotBuffers.
+struct BatchSlot {
+    VkBuffer imageBuffer = VK_NULL_HANDLE;     // Device local, written by the shader
+    VkBuffer readbackBuffer = VK_NULL_HANDLE;  // Host cached copy of imageBuffer
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;         // Compute queue: preprocessing, binning, splatting
+    VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE; // Transfer queue: readback copy
+    VkFence fence = VK_NULL_HANDLE;
+    VkBuffer tileQueueBuffer = VK_NULL_HANDLE; // Tiled kernels: {tile count, next tile} of the persistent mode
+    VkBuffer tileStatsBuffer = VK_NULL_HANDLE; // Tiled kernels: --tile-stats counters, host visible (a placeholder without it)
+};
+
+// The multi-slot counterpart of RenderContext behind the batch in main: the splatting
+// descriptor set layout, pipeline layout and pipeline, one descriptor set, compute and
+// transfer command buffer and fence per frame slot, the splat and copy timelines, and the
+// TransientBufferPool the slots' buffers come from (the preprocessing and binning scratch
+// can be held from it too). Buffers the batch creates itself, such as the uploaded
+// Gaussians, are handed over with adoptBuffer. The destructor waits for the device and
+// destroys all of it.
+class BatchContext {
+public:
+    // Sizes of the buffers each frame takes from the pool
+    struct SlotBufferSizes {
+        VkDeviceSize image;
+        VkDeviceSize readback;          // All views' layers
+        VkDeviceSize tileStats;         // Tiled kernels only
+        bool hostVisibleTileStats;      // --tile-stats reads them from the host
+    };
+
+    // Bindings all slots share: the Gaussians (0) and, for the tiled kernels, the tile lists (2-4)
+    struct SharedBuffers {
+        VkDescriptorBufferInfo gaussians;
+        VkDescriptorBufferInfo tileGaussians;
+        VkDescriptorBufferInfo tileRanges;
+        VkDescriptorBufferInfo activeTiles;
+    };
+
+    // `tiled` adds bindings 2-6 of the tiled kernels to the layout
+    BatchContext(VulkanSetup& vulkan, uint32_t slotCount, bool tiled, uint32_t pushConstantSize,
+                 const SlotBufferSizes& slotBufferSizes);
+    ~BatchContext();
+
+    // Allocates a slot's descriptor set, command buffers and fence, and binds the shared
+    // buffers. At most `slotCount` slots.
+    void initSlot(BatchSlot& slot, const SharedBuffers& shared);
+
+    // Takes a slot's buffers for the frame with pool frame `value` and points the slot's
+    // descriptor set at them where the pool handed out other ones than last time. The
+    // slot's previous frame must have finished.
+    void acquireSlotBuffers(BatchSlot& slot, uint64_t value);
+
+    // Splatting pipeline built on the pipeline layout, destroyed when replaced or with the context
+    void setPipeline(VkPipeline newPipeline);
+    // Destroyed with the context
+    void adoptBuffer(VkBuffer buffer);
+
+    VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
+    VkSemaphore getSplatTimeline() const { return splatTimeline; }
+    VkSemaphore getCopyTimeline() const { return copyTimeline; }
+    TransientBufferPool& getBufferPool() { return bufferPool; }
+
+private:
+    VulkanSetup& vulkan;
+    uint32_t slotCount;
+    bool tiled;
+    SlotBufferSizes slotBufferSizes;
+    TransientBufferPool bufferPool;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkSemaphore splatTimeline;
+    VkSemaphore copyTimeline;
+
+    // Handles of the initialized slots, for the destructor
+    std::vector<VkCommandBuffer> commandBuffers;
+    std::vector<VkCommandBuffer> transferCommandBuffers;
+    std::vector<VkFence> fences;
+    std::vector<VkBuffer> adoptedBuffers;
+
+    void createLayouts(uint32_t pushConstantSize);
+};
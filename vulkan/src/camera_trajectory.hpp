@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+// Camera trajectory file, shared with the rasterization viewer: "GSTJ" magic,
+// uint32 version, uint32 frame count (at least 1), then one camera.bin record
+// (view, projection, image size) per frame. Written by utils.export_camera_trajectory.
+constexpr char TRAJECTORY_MAGIC[4] = {'G', 'S', 'T', 'J'};
+constexpr uint32_t TRAJECTORY_VERSION = 1;
+constexpr uint32_t TRAJECTORY_HEADER_SIZE = sizeof(TRAJECTORY_MAGIC) + 2 * sizeof(uint32_t);
@@ -0,0 +1,139 @@
+#include "file_loader.hpp"
+#include "camera_trajectory.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<std::vector<float>> readCSV(const std::string& filename) {
+    std::vector<std::vector<float>> data;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::vector<float> row;
+        std::stringstream lineStream(line);
+        std::string cell;
+
+        while (std::getline(lineStream, cell, ',')) {
+            row.push_back(std::stof(cell)); // Convert each value to float
+        }
+
+        data.push_back(row);
+    }
+
+    file.close();
+    return data;
+}
+
+std::vector<Gaussian> loadGaussianCSV(const std::string& filename, std::vector<float>* depths) {
+    std::vector<Gaussian> gaussians;
+    auto data = readCSV(filename); // Use the generic CSV reader
+
+    for (const auto& row : data) {
+        if (row.size() != 14 && row.size() != 15) { // Ensure correct number of columns
+            std::cerr << "Invalid row size: " << row.size() << "\n";
+            continue;
+        }
+
+        if (depths && row.size() == 15) {
+            depths->push_back(row[14]);
+        }
+
+        // Map row to Gaussian structure
+        gaussians.push_back(Gaussian{
+            row[0], row[1],  // x, y
+            row[2], row[3], row[4], // r, g, b
+            row[5], row[6], row[7], row[8], // ic11, ic12, ic21, ic22
+            row[9],          // opacity
+            row[10], row[11], row[12], row[13] // min_x, max_x, min_y, max_y
+        });
+    }
+
+    // A partial depth column cannot be matched to its rows
+    if (depths && depths->size() != gaussians.size()) {
+        depths->clear();
+    }
+
+    return gaussians;
+}
+
+std::vector<SceneGaussian> loadSceneBinary(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open scene file: " + filename);
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    if (fileSize % sizeof(SceneGaussian) != 0) {
+        throw std::runtime_error("Scene file size is not a multiple of 16 floats: " + filename);
+    }
+
+    std::vector<SceneGaussian> gaussians(fileSize / sizeof(SceneGaussian));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(gaussians.data()), fileSize);
+    file.close();
+
+    return gaussians;
+}
+
+std::vector<Camera> loadCameras(const std::string& filename) {
+    static_assert(sizeof(Camera) == 136, "Camera must match the 136-byte camera.bin record");
+
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open camera file: " + filename);
+    }
+    const size_t fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    uint32_t frameCount = 1;
+    size_t headerSize = 0;
+    char magic[sizeof(TRAJECTORY_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    if (file && std::memcmp(magic, TRAJECTORY_MAGIC, sizeof(magic)) == 0) {
+        uint32_t version = 0;
+        file.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(&frameCount), sizeof(uint32_t));
+        if (!file) {
+            throw std::runtime_error("Camera trajectory header is truncated: " + filename);
+        }
+        if (version != TRAJECTORY_VERSION) {
+            throw std::runtime_error("Unsupported camera trajectory version: " + std::to_string(version));
+        }
+        if (frameCount == 0) {
+            throw std::runtime_error("Camera trajectory has no frames: " + filename);
+        }
+        headerSize = TRAJECTORY_HEADER_SIZE;
+    } else {
+        // Plain camera.bin, a single record from the start of the file
+        file.clear();
+        file.seekg(0);
+    }
+
+    // Checked before allocating, so a corrupt count cannot ask for more than the file holds
+    if ((fileSize - headerSize) / sizeof(Camera) < frameCount) {
+        throw std::runtime_error("Camera file is truncated: " + filename + " holds fewer than " +
+                                 std::to_string(frameCount) + " cameras");
+    }
+
+    std::vector<Camera> cameras(frameCount);
+    const std::streamsize cameraBytes = static_cast<std::streamsize>(sizeof(Camera) * frameCount);
+    file.read(reinterpret_cast<char*>(cameras.data()), cameraBytes);
+    if (!file || file.gcount() != cameraBytes) {
+        throw std::runtime_error("Camera file is truncated: " + filename);
+    }
+
+    for (const auto& camera : cameras) {
+        if (camera.width <= 0 || camera.height <= 0) {
+            throw std::runtime_error("Camera file contains an empty image size: " + filename);
+        }
+    }
+
+    return cameras;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Preprocessed 2D Gaussian, the layout compute_shader.glsl and tile_shader.glsl read
+struct Gaussian {
+    float x, y;                 // Point position
+    float r, g, b;              // RGB colors
+    float ic11, ic12, ic21, ic22; // Inverse covariance matrix
+    float opacity;              // Opacity
+    float min_x, max_x, min_y, max_y; // Bounding ranges
+};
+
+// Reduced layout for the depth/alpha-only modes: no color, and the bounding box
+// rounded inwards to whole pixels as int16 like HalfGaussian. 36 bytes instead of 56.
+struct DepthGaussian {
+    float x, y;                       // Point position
+    float conic_a, conic_b, conic_c;  // Symmetric inverse covariance (ic11, ic12, ic22)
+    float opacity;                    // Opacity
+    float depth;                      // View-space depth
+    int16_t min_x, max_x;             // ceil(min), floor(max)
+    int16_t min_y, max_y;
+};
+
+// Half-precision layout of compute_shader_fp16.glsl (--precision half): fp32 position,
+// color, opacity and symmetric conic as IEEE half floats, and the bounding box rounded
+// inwards to whole pixels as int16. 32 bytes instead of 56.
+struct HalfGaussian {
+    float x, y;                       // Point position
+    uint16_t r, g;                    // Half floats
+    uint16_t b, opacity;
+    uint16_t conic_a, conic_b;        // ic11, ic12 + ic21
+    uint16_t conic_c, padding;        // ic22
+    int16_t min_x, max_x;             // ceil(min), floor(max)
+    int16_t min_y, max_y;
+};
+
+// Raw 3D Gaussian record (16 floats), the same layout as the rasterization
+// viewer's assets: position, color, 3x3 covariance, opacity
+struct SceneGaussian {
+    float position[3];
+    float color[3];
+    float covariance[9];
+    float opacity;
+};
+
+// One camera.bin record: column-major view and projection matrices and the image size.
+// Also the layout of the preprocessing shader's uniform buffer (std140).
+struct Camera {
+    float view[16];
+    float projection[16];
+    int32_t width, height;
+};
+
+std::vector<std::vector<float>> readCSV(const std::string& filename);
+
+// Rows have 14 columns, plus an optional 15th with the view-space depth. When
+// `depths` is given it receives that column, and is left empty unless every row has it.
+std::vector<Gaussian> loadGaussianCSV(const std::string& filename, std::vector<float>* depths = nullptr);
+
+std::vector<SceneGaussian> loadSceneBinary(const std::string& filename);
+
+// Reads a camera trajectory (see camera_trajectory.hpp) or a plain camera.bin
+std::vector<Camera> loadCameras(const std::string& filename);
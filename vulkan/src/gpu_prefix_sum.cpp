@@ -0,0 +1,152 @@
+#include "gpu_prefix_sum.hpp"
+#include "utils.hpp"
+#include <array>
+#include <stdexcept>
+
+GpuPrefixSum::GpuPrefixSum(VulkanSetup& vulkan, VkBuffer buffer, uint32_t maxCount)
+    : vulkan(vulkan), maxCount(maxCount) {
+    if (maxCount == 0) {
+        throw std::runtime_error("Prefix sum needs at least one element!");
+    }
+
+    levelBuffers.push_back(buffer);
+    levelCapacities.push_back(maxCount);
+    do {
+        uint32_t capacity = (levelCapacities.back() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        VkBuffer levelBuffer;
+        vulkan.createBuffer(sizeof(uint32_t) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, levelBuffer);
+        levelBuffers.push_back(levelBuffer);
+        levelCapacities.push_back(capacity);
+    } while (levelCapacities.back() > 1);
+
+    const uint32_t scanLevels = static_cast<uint32_t>(levelBuffers.size()) - 1;
+
+    // Values (0) and block totals (1)
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create prefix sum descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 2 * scanLevels;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = scanLevels;
+
+    if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create prefix sum descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> setLayouts(scanLevels, descriptorSetLayout);
+    descriptorSets.resize(scanLevels);
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = scanLevels;
+    allocInfo.pSetLayouts = setLayouts.data();
+
+    if (vkAllocateDescriptorSets(vulkan.device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate prefix sum descriptor sets!");
+    }
+
+    for (uint32_t level = 0; level < scanLevels; ++level) {
+        std::array<VkDescriptorBufferInfo, 2> bufferInfos = {};
+        bufferInfos[0] = {levelBuffers[level], 0, VK_WHOLE_SIZE};
+        bufferInfos[1] = {levelBuffers[level + 1], 0, VK_WHOLE_SIZE};
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
+        for (uint32_t i = 0; i < descriptorWrites.size(); ++i) {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = descriptorSets[level];
+            descriptorWrites[i].dstBinding = i;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+        }
+
+        vkUpdateDescriptorSets(vulkan.device, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    }
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(uint32_t);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(vulkan.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create prefix sum pipeline layout!");
+    }
+
+    scanPipeline = vulkan.createComputePipeline("../shaders/prefix_scan.spv", pipelineLayout);
+    addPipeline = vulkan.createComputePipeline("../shaders/prefix_add.spv", pipelineLayout);
+}
+
+GpuPrefixSum::~GpuPrefixSum() {
+    vkDestroyPipeline(vulkan.device, addPipeline, nullptr);
+    vkDestroyPipeline(vulkan.device, scanPipeline, nullptr);
+    vkDestroyPipelineLayout(vulkan.device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(vulkan.device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.device, descriptorSetLayout, nullptr);
+
+    // Level 0 belongs to the caller
+    for (size_t level = 1; level < levelBuffers.size(); ++level) {
+        vulkan.destroyBuffer(levelBuffers[level]);
+    }
+}
+
+void GpuPrefixSum::record(VkCommandBuffer commandBuffer, uint32_t count) {
+    if (count == 0 || count > maxCount) {
+        throw std::runtime_error("Prefix sum count out of range!");
+    }
+
+    const uint32_t scanLevels = static_cast<uint32_t>(descriptorSets.size());
+    std::vector<uint32_t> counts(scanLevels);
+    counts[0] = count;
+    for (uint32_t level = 1; level < scanLevels; ++level) {
+        counts[level] = (counts[level - 1] + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    }
+
+    // Scan every level bottom up; each level writes its block totals to the next
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, scanPipeline);
+    for (uint32_t level = 0; level < scanLevels; ++level) {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[level], 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &counts[level]);
+        vkCmdDispatch(commandBuffer, (counts[level] + BLOCK_SIZE - 1) / BLOCK_SIZE, 1, 1);
+        computeBarrier(commandBuffer);
+    }
+
+    // Then add the scanned totals back top down (the top level is a single block)
+    if (scanLevels > 1) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, addPipeline);
+        for (uint32_t level = scanLevels - 1; level-- > 0;) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[level], 0, nullptr);
+            vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &counts[level]);
+            vkCmdDispatch(commandBuffer, (counts[level] + BLOCK_SIZE - 1) / BLOCK_SIZE, 1, 1);
+            computeBarrier(commandBuffer);
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include <vulkan/vulkan.h>
+#include <vector>
+
+// In-place exclusive prefix sum over a uint32 storage buffer (prefix_scan.glsl,
+// prefix_add.glsl). Blocks of 512 values are scanned, their totals are scanned
+// recursively, and the scanned totals are added back. The per-level scratch
+// buffers are sized for maxCount when the object is created and reused.
+class GpuPrefixSum {
+public:
+    GpuPrefixSum(VulkanSetup& vulkan, VkBuffer buffer, uint32_t maxCount);
+    ~GpuPrefixSum();
+
+    // Records the scan of the first `count` values (1 <= count <= maxCount), followed by a compute barrier
+    void record(VkCommandBuffer commandBuffer, uint32_t count);
+
+    // Single uint holding the sum of all scanned values after record()
+    VkBuffer getTotalBuffer() const { return levelBuffers.back(); }
+
+private:
+    static constexpr uint32_t BLOCK_SIZE = 512;
+
+    VulkanSetup& vulkan;
+    uint32_t maxCount;
+
+    // Level 0 is the caller's buffer, level i + 1 holds the block totals of level i.
+    // The last level has a single value, the grand total.
+    std::vector<VkBuffer> levelBuffers;
+    std::vector<uint32_t> levelCapacities;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+    std::vector<VkDescriptorSet> descriptorSets; // One per scanned level
+    VkPipelineLayout pipelineLayout;
+    VkPipeline scanPipeline;
+    VkPipeline addPipeline;
+};
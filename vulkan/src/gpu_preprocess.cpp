@@ -0,0 +1,295 @@
+#include "gpu_preprocess.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+struct PushConstants {
+    uint32_t sceneIndex;
+    uint32_t sceneGaussianCount;
+    uint32_t outputCount;
+    uint32_t viewIndex;
+};
+
+// std140 array stride of the shader's CameraData: the 136-byte Camera rounded up to 16
+constexpr VkDeviceSize CAMERA_STRIDE = (sizeof(Camera) + 15) / 16 * 16;
+
+} // namespace
+
+GpuPreprocessor::GpuPreprocessor(VulkanSetup& vulkan, const SceneRegistry& registry, uint32_t capacity,
+                                 TransientBufferPool* bufferPool)
+    : vulkan(vulkan), registry(registry), ownedPool(bufferPool ? nullptr : std::make_unique<TransientBufferPool>(vulkan)),
+      pool(bufferPool ? *bufferPool : *ownedPool), gaussianCount(std::max(registry.getMaxGaussianCount(), capacity)) {
+    if (registry.getMaxGaussianCount() == 0) {
+        throw std::runtime_error("Cannot preprocess without a registered scene!");
+    }
+
+    createBuffers();
+    createDescriptorSet();
+    createPipeline();
+}
+
+GpuPreprocessor::~GpuPreprocessor() {
+    vkDeviceWaitIdle(vulkan.device);
+
+    vkDestroyFence(vulkan.device, fence, nullptr);
+    vkFreeCommandBuffers(vulkan.device, vulkan.commandPool, 1, &commandBuffer);
+    vkDestroyPipeline(vulkan.device, pipeline, nullptr);
+    vkDestroyPipelineLayout(vulkan.device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(vulkan.device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.device, descriptorSetLayout, nullptr);
+
+    pool.release(depthBuffer);
+    pool.release(gaussianBuffer);
+    vulkan.destroyBuffer(cameraBuffer);
+}
+
+void GpuPreprocessor::createBuffers() {
+    // Rewritten from the host for every camera, small enough to stay host visible
+    vulkan.createBuffer(CAMERA_STRIDE * MAX_VIEWS, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        cameraBuffer);
+
+    // Outputs are read by later passes on the device; readVisible copies them out
+    const VkBufferUsageFlags outputUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    gaussianBuffer = pool.acquire(sizeof(Gaussian) * static_cast<VkDeviceSize>(gaussianCount), outputUsage,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, TransientBufferPool::UNTIL_RELEASED);
+    depthBuffer = pool.acquire(sizeof(float) * static_cast<VkDeviceSize>(gaussianCount), outputUsage,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, TransientBufferPool::UNTIL_RELEASED);
+}
+
+void GpuPreprocessor::createDescriptorSet() {
+    // Camera (0), Gaussians (1), depths (2); the scenes are set 1, owned by the registry
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings = {};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create preprocessing descriptor set layout!");
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes = {};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = 1;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = 2;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create preprocessing descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(vulkan.device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate preprocessing descriptor set!");
+    }
+
+    std::array<VkDescriptorBufferInfo, 3> bufferInfos = {};
+    bufferInfos[0] = {cameraBuffer, 0, CAMERA_STRIDE * MAX_VIEWS};
+    bufferInfos[1] = {gaussianBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[2] = {depthBuffer, 0, VK_WHOLE_SIZE};
+
+    std::array<VkWriteDescriptorSet, 3> descriptorWrites = {};
+    for (uint32_t i = 0; i < descriptorWrites.size(); ++i) {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = descriptorSet;
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].descriptorType = bindings[i].descriptorType;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(vulkan.device, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+}
+
+void GpuPreprocessor::createPipeline() {
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    const VkDescriptorSetLayout setLayouts[2] = {descriptorSetLayout, registry.getDescriptorSetLayout()};
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(vulkan.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create preprocessing pipeline layout!");
+    }
+
+    pipeline = vulkan.createComputePipeline("../shaders/preprocess_shader.spv", pipelineLayout);
+
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = vulkan.commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(vulkan.device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate preprocessing command buffer!");
+    }
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(vulkan.device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create preprocessing fence!");
+    }
+}
+
+void GpuPreprocessor::setCameras(const std::vector<Camera>& cameras, uint32_t firstView) {
+    if (cameras.empty() || firstView + cameras.size() > MAX_VIEWS) {
+        throw std::runtime_error("Preprocessing takes 1 to " + std::to_string(MAX_VIEWS) + " cameras!");
+    }
+
+    char* mapped = static_cast<char*>(vulkan.mapBuffer(cameraBuffer));
+    for (size_t i = 0; i < cameras.size(); ++i) {
+        std::memcpy(mapped + (firstView + i) * CAMERA_STRIDE, &cameras[i], sizeof(Camera));
+    }
+}
+
+void GpuPreprocessor::record(VkCommandBuffer commandBuffer, uint32_t sceneIndex, uint32_t viewIndex) {
+    if (sceneIndex >= registry.getSceneCount()) {
+        throw std::runtime_error("Scene index out of range!");
+    }
+    if (viewIndex >= MAX_VIEWS) {
+        throw std::runtime_error("View index out of range!");
+    }
+
+    PushConstants pc = {};
+    pc.sceneIndex = sceneIndex;
+    pc.sceneGaussianCount = registry.getResidentGaussianCount(sceneIndex);
+    pc.outputCount = gaussianCount;
+    pc.viewIndex = viewIndex;
+
+    // A previous frame may still be splatting the last outputs
+    computeBarrier(commandBuffer);
+
+    const VkDescriptorSet descriptorSets[2] = {descriptorSet, registry.getDescriptorSet()};
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 2, descriptorSets, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+    vkCmdDispatch(commandBuffer, (gaussianCount + 255) / 256, 1, 1);
+
+    computeBarrier(commandBuffer);
+}
+
+void GpuPreprocessor::run(const Camera& camera, uint32_t sceneIndex) {
+    // The previous run has been waited on, so the uniform buffer is free to rewrite
+    setCameras({camera});
+
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    record(commandBuffer, sceneIndex);
+
+    // Outputs are also consumed by the readback copy
+    computeToTransferBarrier(commandBuffer);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    // Streamed scenes: makes the chunks counted as resident visible to this queue
+    const StreamingUploader* uploader = registry.getUploader();
+    VkSemaphore uploadTimeline = VK_NULL_HANDLE;
+    uint64_t uploadValue = 0;
+    const VkPipelineStageFlags uploadWaitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    if (uploader) {
+        uploadTimeline = uploader->getTimeline();
+        uploadValue = uploader->getCompletedValue();
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = 1;
+        timelineInfo.pWaitSemaphoreValues = &uploadValue;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &uploadTimeline;
+        submitInfo.pWaitDstStageMask = &uploadWaitStage;
+    }
+
+    if (vkQueueSubmit(vulkan.computeQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit preprocessing command buffer!");
+    }
+
+    vkWaitForFences(vulkan.device, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(vulkan.device, 1, &fence);
+}
+
+std::vector<Gaussian> GpuPreprocessor::readVisible(std::vector<float>* depths) {
+    const VkDeviceSize gaussianSize = sizeof(Gaussian) * gaussianCount;
+    const VkDeviceSize depthSize = sizeof(float) * gaussianCount;
+
+    VkBuffer gaussianReadback, depthReadback;
+    vulkan.createReadbackBuffer(gaussianSize, gaussianReadback);
+    vulkan.createReadbackBuffer(depthSize, depthReadback);
+    vulkan.copyBuffer(gaussianBuffer, gaussianReadback, gaussianSize);
+    vulkan.copyBuffer(depthBuffer, depthReadback, depthSize);
+
+    vulkan.invalidateBuffer(gaussianReadback);
+    vulkan.invalidateBuffer(depthReadback);
+    const Gaussian* allGaussians = static_cast<const Gaussian*>(vulkan.mapBuffer(gaussianReadback));
+    const float* allDepths = static_cast<const float*>(vulkan.mapBuffer(depthReadback));
+
+    // Culled Gaussians have depth 0
+    std::vector<uint32_t> visible;
+    for (uint32_t i = 0; i < gaussianCount; ++i) {
+        if (allDepths[i] > 0.0f) {
+            visible.push_back(i);
+        }
+    }
+
+    // Front to back, like the argsort in GaussianScene.preprocess
+    std::stable_sort(visible.begin(), visible.end(), [&](uint32_t a, uint32_t b) {
+        return allDepths[a] < allDepths[b];
+    });
+
+    std::vector<Gaussian> gaussians;
+    gaussians.reserve(visible.size());
+    for (uint32_t i : visible) {
+        gaussians.push_back(allGaussians[i]);
+        if (depths) {
+            depths->push_back(allDepths[i]);
+        }
+    }
+
+    vulkan.destroyBuffer(depthReadback);
+    vulkan.destroyBuffer(gaussianReadback);
+
+    return gaussians;
+}
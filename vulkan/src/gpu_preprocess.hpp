@@ -0,0 +1,71 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include "file_loader.hpp"
+#include "scene_registry.hpp"
+#include "transient_buffer_pool.hpp"
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
+
+// Runs preprocess_shader.glsl: projects a 3D scene of a SceneRegistry for a camera
+// into the 2D Gaussian layout the splatting shaders read. Scenes stay resident in the
+// registry; a new camera only rewrites the uniform buffer and a new scene is only a
+// different push-constant index.
+class GpuPreprocessor {
+public:
+    // Cameras held by the uniform buffer, so one command buffer can preprocess several views
+    static constexpr uint32_t MAX_VIEWS = 64;
+
+    // Outputs are sized for the largest scene registered so far, or `capacity` entries
+    // if that is more; the entries past a scene are written as culled. They are held
+    // from `bufferPool` until the preprocessor is destroyed, or from a pool of its own.
+    GpuPreprocessor(VulkanSetup& vulkan, const SceneRegistry& registry, uint32_t capacity = 0,
+                    TransientBufferPool* bufferPool = nullptr);
+    ~GpuPreprocessor();
+
+    // Uploads the camera and runs the preprocessing pass, blocking until it finishes
+    void run(const Camera& camera, uint32_t sceneIndex = 0);
+
+    // Writes views firstView..firstView+cameras.size()-1 of the camera array. Passes
+    // recorded with them must not be pending.
+    void setCameras(const std::vector<Camera>& cameras, uint32_t firstView = 0);
+
+    // Records the pass for a scene and a view of the last setCameras (or run) into
+    // `commandBuffer`. Waits for earlier readers of the outputs and makes them visible
+    // to later compute passes. Only the scene's resident Gaussians are read, the rest
+    // are written as culled; with streaming, the submission has to wait on the uploader.
+    void record(VkCommandBuffer commandBuffer, uint32_t sceneIndex, uint32_t viewIndex = 0);
+
+    // Gaussians that survived culling in the last run, sorted front to back.
+    // `depths` (if given) receives their view-space depths.
+    std::vector<Gaussian> readVisible(std::vector<float>* depths = nullptr);
+
+    // Entries in the output buffers. Entries past the preprocessed scene's size are culled.
+    uint32_t getGaussianCount() const { return gaussianCount; }
+    VkBuffer getGaussianBuffer() const { return gaussianBuffer; }
+    VkBuffer getDepthBuffer() const { return depthBuffer; }
+
+private:
+    VulkanSetup& vulkan;
+    const SceneRegistry& registry;
+    std::unique_ptr<TransientBufferPool> ownedPool; // Only without a caller's pool
+    TransientBufferPool& pool;
+    uint32_t gaussianCount;
+
+    VkBuffer cameraBuffer;
+    VkBuffer gaussianBuffer;
+    VkBuffer depthBuffer;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSet;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+
+    void createBuffers();
+    void createDescriptorSet();
+    void createPipeline();
+};
@@ -0,0 +1,173 @@
+#include "gpu_profiler.hpp"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+GpuProfiler::GpuProfiler(VulkanSetup& vulkan, uint32_t frameCount, uint32_t passesPerFrame)
+    : vulkan(vulkan), frameCount(frameCount), passesPerFrame(passesPerFrame), framePasses(frameCount), frameBegun(frameCount, false) {
+    msPerTick = vulkan.getDeviceLimits().timestampPeriod / 1e6;
+    computeTimestamps = vulkan.getTimestampValidBits(vulkan.computeQueueFamily) > 0;
+    transferTimestamps = vulkan.getTimestampValidBits(vulkan.transferQueueFamily) > 0;
+
+    if (computeTimestamps) {
+        VkQueryPoolCreateInfo queryInfo = {};
+        queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = 2 * frameCount * passesPerFrame;
+        if (vkCreateQueryPool(vulkan.device, &queryInfo, nullptr, &timestampPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create profiler timestamp query pool!");
+        }
+    } else {
+        std::cout << "The compute queue has no timestamps, the profiler only counts invocations" << std::endl;
+    }
+
+    if (vulkan.supportsPipelineStatistics()) {
+        VkQueryPoolCreateInfo queryInfo = {};
+        queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        queryInfo.queryCount = frameCount * passesPerFrame;
+        queryInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+        if (vkCreateQueryPool(vulkan.device, &queryInfo, nullptr, &statisticsPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create profiler statistics query pool!");
+        }
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    if (timestampPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(vulkan.device, timestampPool, nullptr);
+    }
+    if (statisticsPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(vulkan.device, statisticsPool, nullptr);
+    }
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frame) {
+    if (frame >= frameCount) {
+        throw std::runtime_error("Profiler frame " + std::to_string(frame) + " is out of range!");
+    }
+
+    // Transfer queues cannot reset queries, so the frame's transfer passes are reset here too
+    if (timestampPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, timestampPool, 2 * queryIndex(frame, 0), 2 * passesPerFrame);
+    }
+    if (statisticsPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, statisticsPool, queryIndex(frame, 0), passesPerFrame);
+    }
+
+    framePasses[frame].clear();
+    frameBegun[frame] = true;
+    currentFrame = frame;
+    passOpen = false;
+}
+
+void GpuProfiler::beginPass(VkCommandBuffer commandBuffer, const std::string& name, bool transferQueue) {
+    std::vector<Pass>& passes = framePasses[currentFrame];
+    if (passOpen) {
+        throw std::runtime_error("Profiler pass " + name + " begins inside " + passes.back().name + "!");
+    }
+    if (passes.size() >= passesPerFrame) {
+        throw std::runtime_error("More than " + std::to_string(passesPerFrame) + " profiler passes in a frame!");
+    }
+
+    Pass pass = {};
+    pass.name = name;
+    pass.timed = timestampPool != VK_NULL_HANDLE && (transferQueue ? transferTimestamps : computeTimestamps);
+    pass.statistics = statisticsPool != VK_NULL_HANDLE && !transferQueue;
+
+    const uint32_t query = queryIndex(currentFrame, static_cast<uint32_t>(passes.size()));
+    // Bottom of pipe: the pass starts once everything recorded before it has finished
+    if (pass.timed) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, 2 * query);
+    }
+    if (pass.statistics) {
+        vkCmdBeginQuery(commandBuffer, statisticsPool, query, 0);
+    }
+
+    passes.push_back(pass);
+    passOpen = true;
+}
+
+void GpuProfiler::endPass(VkCommandBuffer commandBuffer) {
+    std::vector<Pass>& passes = framePasses[currentFrame];
+    if (!passOpen) {
+        throw std::runtime_error("Profiler pass ended without beginPass!");
+    }
+
+    const Pass& pass = passes.back();
+    const uint32_t query = queryIndex(currentFrame, static_cast<uint32_t>(passes.size() - 1));
+    if (pass.statistics) {
+        vkCmdEndQuery(commandBuffer, statisticsPool, query);
+    }
+    if (pass.timed) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, 2 * query + 1);
+    }
+    passOpen = false;
+}
+
+std::vector<GpuProfiler::PassTiming> GpuProfiler::getFrameTimings(uint32_t frame) {
+    const std::vector<Pass>& passes = framePasses.at(frame);
+    std::vector<PassTiming> timings(passes.size());
+
+    for (uint32_t i = 0; i < passes.size(); ++i) {
+        timings[i].name = passes[i].name;
+        const uint32_t query = queryIndex(frame, i);
+
+        if (passes[i].timed) {
+            uint64_t ticks[2] = {};
+            vkGetQueryPoolResults(vulkan.device, timestampPool, 2 * query, 2, sizeof(ticks), ticks, sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+            timings[i].gpuMs = (ticks[1] - ticks[0]) * msPerTick;
+        }
+        if (passes[i].statistics) {
+            vkGetQueryPoolResults(vulkan.device, statisticsPool, query, 1, sizeof(uint64_t), &timings[i].invocations,
+                                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+        }
+    }
+    return timings;
+}
+
+void GpuProfiler::writeCsv(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to write profile: " + path);
+    }
+
+    file << "frame,pass,gpu_ms,invocations\n";
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+        if (!frameBegun[frame]) {
+            continue;
+        }
+        for (const PassTiming& pass : getFrameTimings(frame)) {
+            file << frame << "," << pass.name << "," << pass.gpuMs << "," << pass.invocations << "\n";
+        }
+    }
+    std::cout << "GPU profile written to " << path << std::endl;
+}
+
+void GpuProfiler::writeJson(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to write profile: " + path);
+    }
+
+    file << "{\"frames\": [";
+    bool firstFrame = true;
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+        if (!frameBegun[frame]) {
+            continue;
+        }
+        file << (firstFrame ? "\n" : ",\n") << "  {\"frame\": " << frame << ", \"passes\": [";
+        firstFrame = false;
+
+        const std::vector<PassTiming> timings = getFrameTimings(frame);
+        for (size_t i = 0; i < timings.size(); ++i) {
+            file << (i == 0 ? "" : ", ") << "{\"name\": \"" << timings[i].name << "\", \"gpuMs\": " << timings[i].gpuMs
+                 << ", \"invocations\": " << timings[i].invocations << "}";
+        }
+        file << "]}";
+    }
+    file << "\n]}\n";
+    std::cout << "GPU profile written to " << path << std::endl;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-pass GPU timing from timestamp queries. Each frame brackets its passes
+// (preprocess, binning, sort, tile ranges, splat, readback, ...) with beginPass/endPass;
+// a pass's time runs from the end of the previous commands to the end of its own, so
+// passes on one queue add up to the queue's busy time. Where the device supports
+// pipelineStatisticsQuery, compute passes also count their compute shader invocations.
+// Passes on a transfer-only queue are timed when that family has timestamps, but
+// have no statistics.
+class GpuProfiler {
+public:
+    struct PassTiming {
+        std::string name;
+        double gpuMs = 0.0;       // 0 when the pass's queue has no timestamps
+        uint64_t invocations = 0; // Compute shader invocations; 0 without pipeline statistics
+    };
+
+    // Queries for frames 0..frameCount-1, with up to `passesPerFrame` passes each
+    GpuProfiler(VulkanSetup& vulkan, uint32_t frameCount, uint32_t passesPerFrame = 16);
+    ~GpuProfiler();
+
+    bool hasPipelineStatistics() const { return statisticsPool != VK_NULL_HANDLE; }
+
+    // Resets the frame's queries and makes it the frame later passes belong to.
+    // Has to be recorded on the compute queue, before any other pass of the frame.
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+    // Passes of a frame do not nest. `transferQueue` marks a command buffer for the
+    // transfer queue, which cannot run statistics queries.
+    void beginPass(VkCommandBuffer commandBuffer, const std::string& name, bool transferQueue = false);
+    void endPass(VkCommandBuffer commandBuffer);
+
+    // The frame's passes in recording order; its submissions must have finished
+    std::vector<PassTiming> getFrameTimings(uint32_t frame);
+
+    // One line per frame and pass (frame, pass, gpu_ms, invocations) for every frame
+    // that was begun; all of them must have finished
+    void writeCsv(const std::string& path);
+    // The same as {"frames": [{"frame": i, "passes": [{"name", "gpuMs", "invocations"}]}]}
+    void writeJson(const std::string& path);
+
+private:
+    struct Pass {
+        std::string name;
+        bool timed;
+        bool statistics;
+    };
+
+    VulkanSetup& vulkan;
+    uint32_t frameCount;
+    uint32_t passesPerFrame;
+    double msPerTick;
+    bool computeTimestamps;
+    bool transferTimestamps;
+
+    VkQueryPool timestampPool = VK_NULL_HANDLE;  // Two per pass
+    VkQueryPool statisticsPool = VK_NULL_HANDLE; // One per pass
+    std::vector<std::vector<Pass>> framePasses;
+    std::vector<bool> frameBegun;
+    uint32_t currentFrame = 0;
+    bool passOpen = false;
+
+    uint32_t queryIndex(uint32_t frame, uint32_t pass) const { return frame * passesPerFrame + pass; }
+};
@@ -0,0 +1,229 @@
+#include "gpu_radix_sort.hpp"
+#include "utils.hpp"
+#include <array>
+#include <stdexcept>
+
+GpuRadixSort::GpuRadixSort(VulkanSetup& vulkan, VkBuffer keys, VkBuffer values, uint32_t maxCount, uint32_t keyBits)
+    : vulkan(vulkan), maxCount(maxCount), keyBits(keyBits), keys(keys), values(values) {
+    if (keyBits != 32 && keyBits != 64) {
+        throw std::runtime_error("Radix sort keys must be 32 or 64 bits!");
+    }
+    if (maxCount == 0) {
+        throw std::runtime_error("Radix sort needs at least one element!");
+    }
+
+    keyWords = keyBits / 32;
+    maxBlocks = (maxCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    // Scratch space is allocated once for the largest sort
+    vulkan.createBuffer(sizeof(uint32_t) * keyWords * static_cast<VkDeviceSize>(maxCount),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, scratchKeys);
+    vulkan.createBuffer(sizeof(uint32_t) * static_cast<VkDeviceSize>(maxCount),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, scratchValues);
+    vulkan.createBuffer(sizeof(uint32_t) * 256 * static_cast<VkDeviceSize>(maxBlocks),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, histogramBuffer);
+    vulkan.createBuffer(sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, countBuffer);
+    vulkan.createBuffer(sizeof(VkDispatchIndirectCommand),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, dispatchBuffer);
+
+    histogramScan = std::make_unique<GpuPrefixSum>(vulkan, histogramBuffer, 256 * maxBlocks);
+
+    createDescriptorSets();
+    createPipelines();
+}
+
+GpuRadixSort::~GpuRadixSort() {
+    vkDestroyPipeline(vulkan.device, scatterPipeline, nullptr);
+    vkDestroyPipeline(vulkan.device, histogramPipeline, nullptr);
+    vkDestroyPipeline(vulkan.device, setupPipeline, nullptr);
+    vkDestroyPipelineLayout(vulkan.device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(vulkan.device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.device, descriptorSetLayout, nullptr);
+
+    histogramScan.reset();
+
+    vulkan.destroyBuffer(dispatchBuffer);
+    vulkan.destroyBuffer(countBuffer);
+    vulkan.destroyBuffer(histogramBuffer);
+    vulkan.destroyBuffer(scratchValues);
+    vulkan.destroyBuffer(scratchKeys);
+}
+
+void GpuRadixSort::createDescriptorSets() {
+    // Keys in (0), values in (1), keys out (2), values out (3), histograms (4), count (5), dispatch args (6)
+    std::array<VkDescriptorSetLayoutBinding, 7> bindings = {};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create radix sort descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 2 * bindings.size();
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 2;
+
+    if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create radix sort descriptor pool!");
+    }
+
+    std::array<VkDescriptorSetLayout, 2> setLayouts = {descriptorSetLayout, descriptorSetLayout};
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = setLayouts.size();
+    allocInfo.pSetLayouts = setLayouts.data();
+
+    if (vkAllocateDescriptorSets(vulkan.device, &allocInfo, descriptorSets) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate radix sort descriptor sets!");
+    }
+
+    for (uint32_t direction = 0; direction < 2; ++direction) {
+        VkBuffer keysIn = direction == 0 ? keys : scratchKeys;
+        VkBuffer valuesIn = direction == 0 ? values : scratchValues;
+        VkBuffer keysOut = direction == 0 ? scratchKeys : keys;
+        VkBuffer valuesOut = direction == 0 ? scratchValues : values;
+
+        std::array<VkDescriptorBufferInfo, 7> bufferInfos = {};
+        bufferInfos[0] = {keysIn, 0, VK_WHOLE_SIZE};
+        bufferInfos[1] = {valuesIn, 0, VK_WHOLE_SIZE};
+        bufferInfos[2] = {keysOut, 0, VK_WHOLE_SIZE};
+        bufferInfos[3] = {valuesOut, 0, VK_WHOLE_SIZE};
+        bufferInfos[4] = {histogramBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[5] = {countBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[6] = {dispatchBuffer, 0, VK_WHOLE_SIZE};
+
+        std::array<VkWriteDescriptorSet, 7> descriptorWrites = {};
+        for (uint32_t i = 0; i < descriptorWrites.size(); ++i) {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = descriptorSets[direction];
+            descriptorWrites[i].dstBinding = i;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+        }
+
+        vkUpdateDescriptorSets(vulkan.device, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    }
+}
+
+void GpuRadixSort::createPipelines() {
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(vulkan.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create radix sort pipeline layout!");
+    }
+
+    setupPipeline = vulkan.createComputePipeline("../shaders/sort_setup.spv", pipelineLayout);
+    histogramPipeline = vulkan.createComputePipeline("../shaders/sort_histogram.spv", pipelineLayout);
+    scatterPipeline = vulkan.createComputePipeline("../shaders/sort_scatter.spv", pipelineLayout);
+}
+
+void GpuRadixSort::record(VkCommandBuffer commandBuffer, uint32_t count, uint32_t sortBits) {
+    if (count > maxCount) {
+        throw std::runtime_error("Radix sort count exceeds the allocated capacity!");
+    }
+
+    vkCmdUpdateBuffer(commandBuffer, countBuffer, 0, sizeof(uint32_t), &count);
+    recordPasses(commandBuffer, sortBits);
+}
+
+void GpuRadixSort::recordIndirect(VkCommandBuffer commandBuffer, VkBuffer srcCountBuffer, VkDeviceSize countOffset, uint32_t sortBits) {
+    // The count is usually produced by the compute pass right before
+    computeToTransferBarrier(commandBuffer);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.srcOffset = countOffset;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = sizeof(uint32_t);
+    vkCmdCopyBuffer(commandBuffer, srcCountBuffer, countBuffer, 1, &copyRegion);
+
+    recordPasses(commandBuffer, sortBits);
+}
+
+void GpuRadixSort::recordPasses(VkCommandBuffer commandBuffer, uint32_t sortBits) {
+    if (sortBits == 0 || sortBits > keyBits) {
+        sortBits = keyBits;
+    }
+    const uint32_t passCount = (sortBits + 7) / 8;
+
+    transferToComputeBarrier(commandBuffer);
+
+    // Workgroup count for the histogram and scatter passes, from the count on the device
+    PushConstants pc = {keyWords, 0, 0, maxBlocks};
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, setupPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[0], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+
+    computeToIndirectBarrier(commandBuffer);
+
+    for (uint32_t pass = 0; pass < passCount; ++pass) {
+        VkDescriptorSet descriptorSet = descriptorSets[pass % 2];
+        pc.word = (pass * 8) / 32;
+        pc.shift = (pass * 8) % 32;
+
+        // Blocks past the count are not dispatched, so their histograms must read as zero
+        computeToTransferBarrier(commandBuffer);
+        vkCmdFillBuffer(commandBuffer, histogramBuffer, 0, VK_WHOLE_SIZE, 0);
+        transferToComputeBarrier(commandBuffer);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, histogramPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer, 0);
+        computeBarrier(commandBuffer);
+
+        histogramScan->record(commandBuffer, 256 * maxBlocks);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, scatterPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+        vkCmdDispatchIndirect(commandBuffer, dispatchBuffer, 0);
+        computeBarrier(commandBuffer);
+    }
+
+    // An odd number of passes leaves the result in the scratch buffers
+    if (passCount % 2 == 1) {
+        computeToTransferBarrier(commandBuffer);
+
+        VkBufferCopy keyRegion = {0, 0, sizeof(uint32_t) * keyWords * static_cast<VkDeviceSize>(maxCount)};
+        VkBufferCopy valueRegion = {0, 0, sizeof(uint32_t) * static_cast<VkDeviceSize>(maxCount)};
+        vkCmdCopyBuffer(commandBuffer, scratchKeys, keys, 1, &keyRegion);
+        vkCmdCopyBuffer(commandBuffer, scratchValues, values, 1, &valueRegion);
+
+        transferToComputeBarrier(commandBuffer);
+    }
+}
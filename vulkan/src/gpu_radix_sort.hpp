@@ -0,0 +1,67 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include "gpu_prefix_sum.hpp"
+#include <vulkan/vulkan.h>
+#include <memory>
+
+// Stable LSD radix sort of key/value pairs on the device (sort_setup.glsl,
+// sort_histogram.glsl, sort_scatter.glsl and a GpuPrefixSum over the histograms).
+// Keys are 32- or 64-bit (64-bit keys are stored as two uints, low word first),
+// values are uint32. Each 8-bit digit is one histogram + scan + scatter pass,
+// ping-ponging between the caller's buffers and scratch buffers that are sized
+// for maxCount once and reused. The sorted pairs always end up back in the
+// caller's buffers.
+class GpuRadixSort {
+public:
+    // `keys` and `values` need STORAGE and TRANSFER_SRC/DST usage
+    GpuRadixSort(VulkanSetup& vulkan, VkBuffer keys, VkBuffer values, uint32_t maxCount, uint32_t keyBits);
+    ~GpuRadixSort();
+
+    // Records a sort of the first `count` pairs. Only the low `sortBits` bits of
+    // the keys are compared (0 = all of them).
+    void record(VkCommandBuffer commandBuffer, uint32_t count, uint32_t sortBits = 0);
+
+    // Same, with the count read on the device from a uint32 at `countOffset` in
+    // `countBuffer` (e.g. written by an earlier compute pass), so the host never
+    // needs to know it
+    void recordIndirect(VkCommandBuffer commandBuffer, VkBuffer countBuffer, VkDeviceSize countOffset, uint32_t sortBits = 0);
+
+private:
+    static constexpr uint32_t BLOCK_SIZE = 1024;
+
+    struct PushConstants {
+        uint32_t keyWords;
+        uint32_t word;
+        uint32_t shift;
+        uint32_t blockStride;
+    };
+
+    VulkanSetup& vulkan;
+    uint32_t maxCount;
+    uint32_t keyBits;
+    uint32_t keyWords;
+    uint32_t maxBlocks;
+
+    VkBuffer keys;
+    VkBuffer values;
+    VkBuffer scratchKeys;
+    VkBuffer scratchValues;
+    VkBuffer histogramBuffer;
+    VkBuffer countBuffer;
+    VkBuffer dispatchBuffer;
+
+    std::unique_ptr<GpuPrefixSum> histogramScan;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSets[2]; // [0] caller -> scratch, [1] scratch -> caller
+    VkPipelineLayout pipelineLayout;
+    VkPipeline setupPipeline;
+    VkPipeline histogramPipeline;
+    VkPipeline scatterPipeline;
+
+    void createDescriptorSets();
+    void createPipelines();
+    void recordPasses(VkCommandBuffer commandBuffer, uint32_t sortBits);
+};
@@ -0,0 +1,313 @@
+#include "gpu_tile_binning.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+GpuTileBinner::GpuTileBinner(VulkanSetup& vulkan, VkBuffer gaussianBuffer, VkBuffer depthBuffer, uint32_t gaussianCount,
+                             VkRect2D region, uint32_t maxPairs, bool orderByCost, uint32_t persistentGroups,
+                             TransientBufferPool* bufferPool)
+    : vulkan(vulkan), ownedPool(bufferPool ? nullptr : std::make_unique<TransientBufferPool>(vulkan)),
+      pool(bufferPool ? *bufferPool : *ownedPool), gaussianCount(gaussianCount), region(region), maxPairs(maxPairs), orderByCost(orderByCost),
+      persistentGroups(persistentGroups), gaussianBuffer(gaussianBuffer), depthBuffer(depthBuffer) {
+    if (gaussianCount == 0 || maxPairs == 0) {
+        throw std::runtime_error("Tile binning needs at least one Gaussian and one pair!");
+    }
+
+    updateTileCount();
+    tileCapacity = tileCount;
+
+    // Cost keys range over [0, maxPairs]
+    costBits = 1;
+    while (costBits < 32 && (1ull << costBits) <= maxPairs) {
+        ++costBits;
+    }
+
+    createBuffers();
+    createTileBuffers();
+    offsetScan = std::make_unique<GpuPrefixSum>(vulkan, tileCountBuffer, gaussianCount);
+    pairSort = std::make_unique<GpuRadixSort>(vulkan, keyBuffer, valueBuffer, maxPairs, 64);
+    if (orderByCost) {
+        costSort = std::make_unique<GpuRadixSort>(vulkan, tileCostBuffer, activeTileBuffer, tileCapacity, 32);
+    }
+    createDescriptorSet();
+    updateDescriptorSet();
+    createPipelines();
+}
+
+void GpuTileBinner::updateTileCount() {
+    const uint32_t tilesX = (region.extent.width + TILE_SIZE - 1) / TILE_SIZE;
+    const uint32_t tilesY = (region.extent.height + TILE_SIZE - 1) / TILE_SIZE;
+    tileCount = tilesX * tilesY;
+
+    // The tile index only needs enough bits above the 32 depth bits to tell the tiles apart
+    uint32_t tileBits = 0;
+    while ((1u << tileBits) < tileCount) {
+        ++tileBits;
+    }
+    sortBits = 32 + tileBits;
+}
+
+void GpuTileBinner::setRegion(VkRect2D newRegion) {
+    region = newRegion;
+    updateTileCount();
+    if (tileCount <= tileCapacity) {
+        return;
+    }
+
+    // Doubling keeps a growing region to a logarithmic number of reallocations
+    costSort.reset();
+    releaseTileBuffers();
+    tileCapacity = std::max(tileCount, tileCapacity * 2);
+    createTileBuffers();
+    if (orderByCost) {
+        costSort = std::make_unique<GpuRadixSort>(vulkan, tileCostBuffer, activeTileBuffer, tileCapacity, 32);
+    }
+    updateDescriptorSet();
+}
+
+GpuTileBinner::~GpuTileBinner() {
+    vkDeviceWaitIdle(vulkan.device);
+
+    vkDestroyPipeline(vulkan.device, costPipeline, nullptr);
+    vkDestroyPipeline(vulkan.device, setupPipeline, nullptr);
+    vkDestroyPipeline(vulkan.device, rangesPipeline, nullptr);
+    vkDestroyPipeline(vulkan.device, duplicatePipeline, nullptr);
+    vkDestroyPipeline(vulkan.device, countPipeline, nullptr);
+    vkDestroyPipelineLayout(vulkan.device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(vulkan.device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.device, descriptorSetLayout, nullptr);
+
+    costSort.reset();
+    pairSort.reset();
+    offsetScan.reset();
+
+    releaseTileBuffers();
+    vulkan.destroyBuffer(dispatchBuffer);
+    vulkan.destroyBuffer(stateBuffer);
+    pool.release(valueBuffer);
+    pool.release(keyBuffer);
+    pool.release(tileCountBuffer);
+}
+
+VkBuffer GpuTileBinner::acquireScratch(VkDeviceSize size, VkBufferUsageFlags usage) {
+    return pool.acquire(size, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, TransientBufferPool::UNTIL_RELEASED);
+}
+
+void GpuTileBinner::createBuffers() {
+    const VkBufferUsageFlags sortUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    tileCountBuffer = acquireScratch(sizeof(uint32_t) * static_cast<VkDeviceSize>(gaussianCount), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    keyBuffer = acquireScratch(sizeof(uint32_t) * 2 * static_cast<VkDeviceSize>(maxPairs), sortUsage);
+    valueBuffer = acquireScratch(sizeof(uint32_t) * static_cast<VkDeviceSize>(maxPairs), sortUsage);
+
+    // The counters are also the count source of the indirect sort, and stay host visible for readStats
+    vulkan.createBuffer(sizeof(Stats),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        stateBuffer);
+    vulkan.createBuffer(sizeof(VkDispatchIndirectCommand) * 3,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, dispatchBuffer);
+}
+
+void GpuTileBinner::createTileBuffers() {
+    const VkBufferUsageFlags sortUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    rangeBuffer = acquireScratch(sizeof(uint32_t) * 2 * static_cast<VkDeviceSize>(tileCapacity),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    // The active tile list doubles as the values of the cost sort
+    activeTileBuffer = acquireScratch(sizeof(uint32_t) * static_cast<VkDeviceSize>(tileCapacity), sortUsage);
+    tileCostBuffer = acquireScratch(sizeof(uint32_t) * static_cast<VkDeviceSize>(tileCapacity), sortUsage);
+}
+
+void GpuTileBinner::releaseTileBuffers() {
+    pool.release(tileCostBuffer);
+    pool.release(activeTileBuffer);
+    pool.release(rangeBuffer);
+}
+
+void GpuTileBinner::createDescriptorSet() {
+    // Gaussians (0), depths (1), tile counts/offsets (2), keys (3), values (4), tile ranges (5),
+    // active tiles (6), counters (7), dispatch arguments (8), scan total (9), tile cost keys (10)
+    std::array<VkDescriptorSetLayoutBinding, 11> bindings = {};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create tile binning descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = bindings.size();
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create tile binning descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(vulkan.device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate tile binning descriptor set!");
+    }
+}
+
+void GpuTileBinner::updateDescriptorSet() {
+    std::array<VkDescriptorBufferInfo, 11> bufferInfos = {};
+    bufferInfos[0] = {gaussianBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[1] = {depthBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[2] = {tileCountBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[3] = {keyBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[4] = {valueBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[5] = {rangeBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[6] = {activeTileBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[7] = {stateBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[8] = {dispatchBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[9] = {offsetScan->getTotalBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[10] = {tileCostBuffer, 0, VK_WHOLE_SIZE};
+
+    std::array<VkWriteDescriptorSet, 11> descriptorWrites = {};
+    for (uint32_t i = 0; i < descriptorWrites.size(); ++i) {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = descriptorSet;
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(vulkan.device, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+}
+
+void GpuTileBinner::createPipelines() {
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(vulkan.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create tile binning pipeline layout!");
+    }
+
+    countPipeline = vulkan.createComputePipeline("../shaders/tile_count.spv", pipelineLayout);
+    duplicatePipeline = vulkan.createComputePipeline("../shaders/tile_duplicate.spv", pipelineLayout);
+    rangesPipeline = vulkan.createComputePipeline("../shaders/tile_ranges.spv", pipelineLayout);
+    setupPipeline = vulkan.createComputePipeline("../shaders/tile_setup.spv", pipelineLayout);
+    costPipeline = orderByCost ? vulkan.createComputePipeline("../shaders/tile_cost.spv", pipelineLayout) : VK_NULL_HANDLE;
+}
+
+void GpuTileBinner::record(VkCommandBuffer commandBuffer, GpuProfiler* profiler) {
+    PushConstants pc = {};
+    pc.regionOffset[0] = region.offset.x;
+    pc.regionOffset[1] = region.offset.y;
+    pc.regionSize[0] = static_cast<int32_t>(region.extent.width);
+    pc.regionSize[1] = static_cast<int32_t>(region.extent.height);
+    pc.gaussianCount = gaussianCount;
+    pc.maxPairs = maxPairs;
+    pc.persistentGroups = persistentGroups;
+
+    const uint32_t gaussianGroups = (gaussianCount + 255) / 256;
+
+    auto bind = [&](VkPipeline pipeline, uint32_t stage) {
+        pc.stage = stage;
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+    };
+
+    auto beginPass = [&](const char* name) {
+        if (profiler) {
+            profiler->beginPass(commandBuffer, name);
+        }
+    };
+    auto endPass = [&]() {
+        if (profiler) {
+            profiler->endPass(commandBuffer);
+        }
+    };
+
+    beginPass("binning");
+
+    // A previous frame may still be reading the ranges; empty tiles keep the cleared [0, 0).
+    // Only the region's tiles, the pooled buffer may be larger.
+    computeToTransferBarrier(commandBuffer);
+    vkCmdFillBuffer(commandBuffer, rangeBuffer, 0, sizeof(uint32_t) * 2 * static_cast<VkDeviceSize>(tileCount), 0);
+    vkCmdFillBuffer(commandBuffer, stateBuffer, 0, VK_WHOLE_SIZE, 0);
+    transferToComputeBarrier(commandBuffer);
+
+    // Tiles per Gaussian, scanned into pair offsets
+    bind(countPipeline, 0);
+    vkCmdDispatch(commandBuffer, gaussianGroups, 1, 1);
+    computeBarrier(commandBuffer);
+
+    offsetScan->record(commandBuffer, gaussianCount);
+
+    bind(setupPipeline, 0);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+    computeToIndirectBarrier(commandBuffer);
+
+    // (tile | depth) keys, sorted by the pair count the setup pass left in the counters
+    bind(duplicatePipeline, 0);
+    vkCmdDispatch(commandBuffer, gaussianGroups, 1, 1);
+    computeBarrier(commandBuffer);
+    endPass();
+
+    beginPass("sort");
+    pairSort->recordIndirect(commandBuffer, stateBuffer, 0, sortBits);
+    endPass();
+
+    beginPass("tile ranges");
+    bind(rangesPipeline, 0);
+    vkCmdDispatchIndirect(commandBuffer, dispatchBuffer, 0);
+    computeBarrier(commandBuffer);
+
+    // Heaviest tiles first, sorted by the active tile count in the counters
+    if (orderByCost) {
+        bind(costPipeline, 0);
+        vkCmdDispatch(commandBuffer, (tileCount + 255) / 256, 1, 1);
+        computeBarrier(commandBuffer);
+
+        costSort->recordIndirect(commandBuffer, stateBuffer, getActiveTileCountOffset(), costBits);
+    }
+
+    bind(setupPipeline, 1);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+    computeToIndirectBarrier(commandBuffer);
+    endPass();
+}
+
+GpuTileBinner::Stats GpuTileBinner::readStats() {
+    Stats stats;
+    std::memcpy(&stats, vulkan.mapBuffer(stateBuffer), sizeof(Stats));
+    return stats;
+}
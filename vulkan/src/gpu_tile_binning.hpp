@@ -0,0 +1,127 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include "gpu_prefix_sum.hpp"
+#include "gpu_radix_sort.hpp"
+#include "gpu_profiler.hpp"
+#include "transient_buffer_pool.hpp"
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <memory>
+
+// Builds the per-tile Gaussian lists of tile_shader.glsl on the device from the
+// GpuPreprocessor output (tile_count.glsl, tile_duplicate.glsl, tile_ranges.glsl,
+// tile_setup.glsl): count the tiles per Gaussian, scan the counts into offsets,
+// write one (tile | depth) key per touched tile, sort the keys, and find each
+// tile's range. Every count stays on the device, and the splatting pass is
+// launched with vkCmdDispatchIndirect over the non-empty tiles. For persistent
+// threads the active tile list can also be sorted by pair count, heaviest first
+// (tile_cost.glsl and a second GpuRadixSort).
+class GpuTileBinner {
+public:
+    // Counters left in host-visible memory by the last recorded run
+    struct Stats {
+        uint32_t pairCount;       // Pairs in the tile lists
+        uint32_t totalPairs;      // Pairs requested; more than pairCount means the capacity was too small
+        uint32_t activeTileCount; // Tiles with at least one Gaussian
+    };
+
+    // `gaussianBuffer` and `depthBuffer` hold `gaussianCount` preprocessed Gaussians
+    // (depth 0 = culled). `region` is the render rectangle, binned into 16x16 tiles.
+    // `maxPairs` is the capacity of the tile/Gaussian pair list. `orderByCost` sorts the
+    // active tile list by descending pair count. `persistentGroups` caps the persistent
+    // splatting dispatch, which is clamped to the active tile count. The scratch buffers
+    // (counts, keys, tile lists) are held from `bufferPool` until the binner replaces or
+    // releases them, or from a pool of its own without one.
+    GpuTileBinner(VulkanSetup& vulkan, VkBuffer gaussianBuffer, VkBuffer depthBuffer, uint32_t gaussianCount,
+                  VkRect2D region, uint32_t maxPairs, bool orderByCost = false, uint32_t persistentGroups = 0,
+                  TransientBufferPool* bufferPool = nullptr);
+    ~GpuTileBinner();
+
+    // Re-targets the binning at another render rectangle. The pipelines, the pair buffers
+    // and the descriptor set are kept; the per-tile buffers are only replaced when the
+    // region has more tiles than they hold, and then grow to at least twice their size.
+    // Commands recorded for the previous region must have finished.
+    void setRegion(VkRect2D region);
+
+    // Records all binning passes, followed by the barrier for the indirect splatting dispatch.
+    // With a profiler they are timed as "binning" (count, scan, keys), "sort" and "tile ranges".
+    void record(VkCommandBuffer commandBuffer, GpuProfiler* profiler = nullptr);
+
+    // Bindings 2-4 of tile_shader.glsl
+    VkBuffer getTileGaussianBuffer() const { return valueBuffer; }
+    VkBuffer getTileRangeBuffer() const { return rangeBuffer; }
+    VkBuffer getActiveTileBuffer() const { return activeTileBuffer; }
+
+    // VkDispatchIndirectCommand of the splatting pass, one workgroup per active tile
+    VkBuffer getDispatchBuffer() const { return dispatchBuffer; }
+    VkDeviceSize getSplatDispatchOffset() const { return sizeof(VkDispatchIndirectCommand); }
+    // Persistent threads: min(active tiles, persistentGroups) workgroups
+    VkDeviceSize getPersistentDispatchOffset() const { return 2 * sizeof(VkDispatchIndirectCommand); }
+
+    // The counters of Stats, for copying the active tile count into a work queue
+    VkBuffer getStateBuffer() const { return stateBuffer; }
+    VkDeviceSize getActiveTileCountOffset() const { return offsetof(Stats, activeTileCount); }
+
+    // Valid once the command buffer of the last record() has finished
+    Stats readStats();
+
+private:
+    static constexpr uint32_t TILE_SIZE = 16;
+
+    struct PushConstants {
+        int32_t regionOffset[2];
+        int32_t regionSize[2];
+        uint32_t gaussianCount;
+        uint32_t maxPairs;
+        uint32_t stage;
+        uint32_t persistentGroups; // tile_setup.glsl only
+    };
+
+    VulkanSetup& vulkan;
+    std::unique_ptr<TransientBufferPool> ownedPool; // Only without a caller's pool
+    TransientBufferPool& pool;
+    uint32_t gaussianCount;
+    VkRect2D region;
+    uint32_t maxPairs;
+    uint32_t tileCount;
+    uint32_t tileCapacity; // Tiles the per-tile buffers hold, >= tileCount
+    uint32_t sortBits;
+    bool orderByCost;
+    uint32_t persistentGroups;
+    uint32_t costBits;
+
+    VkBuffer gaussianBuffer;
+    VkBuffer depthBuffer;
+    VkBuffer tileCountBuffer;
+    VkBuffer keyBuffer;
+    VkBuffer valueBuffer;
+    VkBuffer rangeBuffer;
+    VkBuffer activeTileBuffer;
+    VkBuffer stateBuffer;
+    VkBuffer dispatchBuffer;
+    VkBuffer tileCostBuffer;
+
+    std::unique_ptr<GpuPrefixSum> offsetScan;
+    std::unique_ptr<GpuRadixSort> pairSort;
+    std::unique_ptr<GpuRadixSort> costSort;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSet;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline countPipeline;
+    VkPipeline duplicatePipeline;
+    VkPipeline rangesPipeline;
+    VkPipeline setupPipeline;
+    VkPipeline costPipeline;
+
+    void createBuffers();
+    void createTileBuffers();
+    void releaseTileBuffers();
+    VkBuffer acquireScratch(VkDeviceSize size, VkBufferUsageFlags usage);
+    void createDescriptorSet();
+    void updateDescriptorSet();
+    void createPipelines();
+    void updateTileCount();
+};
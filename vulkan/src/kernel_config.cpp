@@ -0,0 +1,128 @@
+#include "kernel_config.hpp"
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const VkSpecializationMapEntry SPECIALIZATION_ENTRIES[] = {
+    {0, offsetof(KernelConfig, workgroupX), sizeof(uint32_t)},
+    {1, offsetof(KernelConfig, workgroupY), sizeof(uint32_t)},
+    {2, offsetof(KernelConfig, pixelsPerThread), sizeof(uint32_t)},
+    {3, offsetof(KernelConfig, batchSize), sizeof(uint32_t)},
+    {4, offsetof(KernelConfig, persistentThreads), sizeof(uint32_t)},
+    {5, offsetof(KernelConfig, tileStats), sizeof(uint32_t)},
+};
+
+// Upper bound of the tiled kernel's shared memory per batched Gaussian
+// (position, conic and opacity, color, bounds, each padded to a vec4)
+constexpr uint32_t SHARED_BYTES_PER_GAUSSIAN = 64;
+
+// Pixels along x and y covered by the tiled kernel's workgroups, fixed by the binning
+constexpr uint32_t TILE_SIZE = 16;
+
+} // namespace
+
+std::string KernelConfig::describe() const {
+    std::ostringstream text;
+    text << workgroupX << "x" << workgroupY << " workgroup, " << pixelsPerThread
+         << " pixel(s) per thread, batch " << batchSize;
+    return text.str();
+}
+
+VkSpecializationInfo kernelSpecializationInfo(const KernelConfig& config) {
+    VkSpecializationInfo info = {};
+    info.mapEntryCount = static_cast<uint32_t>(sizeof(SPECIALIZATION_ENTRIES) / sizeof(SPECIALIZATION_ENTRIES[0]));
+    info.pMapEntries = SPECIALIZATION_ENTRIES;
+    info.dataSize = sizeof(KernelConfig);
+    info.pData = &config;
+    return info;
+}
+
+std::vector<KernelConfig> kernelConfigCandidates(const std::string& kernel, const VkPhysicalDeviceLimits& limits) {
+    std::vector<KernelConfig> candidates;
+
+    if (kernel == "tiled" || kernel == "subgroup") {
+        for (uint32_t batchSize : {256u, 64u, 128u, 512u}) {
+            if (batchSize * SHARED_BYTES_PER_GAUSSIAN + 16 > limits.maxComputeSharedMemorySize) {
+                continue;
+            }
+            KernelConfig config;
+            config.workgroupX = TILE_SIZE;
+            config.workgroupY = TILE_SIZE;
+            config.batchSize = batchSize;
+            candidates.push_back(config);
+        }
+        return candidates;
+    }
+
+    const uint32_t shapes[][2] = {{16, 16}, {8, 8}, {32, 8}, {8, 32}, {64, 4}, {32, 16}, {32, 32}};
+    for (const auto& shape : shapes) {
+        if (shape[0] > limits.maxComputeWorkGroupSize[0] || shape[1] > limits.maxComputeWorkGroupSize[1] ||
+            shape[0] * shape[1] > limits.maxComputeWorkGroupInvocations) {
+            continue;
+        }
+        for (uint32_t pixelsPerThread : {1u, 2u, 4u}) {
+            KernelConfig config;
+            config.workgroupX = shape[0];
+            config.workgroupY = shape[1];
+            config.pixelsPerThread = pixelsPerThread;
+            candidates.push_back(config);
+        }
+    }
+
+    return candidates;
+}
+
+std::string kernelConfigPath(const std::string& deviceUUID) {
+    return "kernel_config_" + deviceUUID + ".txt";
+}
+
+bool loadKernelConfig(const std::string& path, const std::string& kernel, KernelConfig& config) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        KernelConfig loaded;
+        if (!(fields >> name >> loaded.workgroupX >> loaded.workgroupY >> loaded.pixelsPerThread >> loaded.batchSize)) {
+            continue;
+        }
+        if (name != kernel || loaded.workgroupX == 0 || loaded.workgroupY == 0 ||
+            loaded.pixelsPerThread == 0 || loaded.batchSize == 0) {
+            continue;
+        }
+        config = loaded;
+        return true;
+    }
+    return false;
+}
+
+void saveKernelConfig(const std::string& path, const std::string& kernel, const KernelConfig& config) {
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            if (fields >> name && name != kernel) {
+                lines.push_back(line);
+            }
+        }
+    }
+
+    std::ostringstream entry;
+    entry << kernel << " " << config.workgroupX << " " << config.workgroupY << " "
+          << config.pixelsPerThread << " " << config.batchSize;
+    lines.push_back(entry.str());
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to write kernel config: " + path);
+    }
+    for (const auto& line : lines) {
+        file << line << "\n";
+    }
+}
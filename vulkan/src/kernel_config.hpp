@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Launch shape of a splatting kernel, passed to the shaders as specialization
+// constants 0-3 (4 and 5 switch modes of the tiled kernels). The naive and depth
+// kernels use the workgroup size and the number of horizontally adjacent pixels
+// each invocation shades; the tiled kernels keep their 16x16 tile workgroup and
+// only use the shared-memory batch size.
+struct KernelConfig {
+    uint32_t workgroupX = 16;       // constant_id 0
+    uint32_t workgroupY = 16;       // constant_id 1
+    uint32_t pixelsPerThread = 1;   // constant_id 2
+    uint32_t batchSize = 256;       // constant_id 3, Gaussians per shared-memory batch
+    uint32_t persistentThreads = 0; // constant_id 4, tiled kernels only; set by --persistent, not tuned
+    uint32_t tileStats = 0;         // constant_id 5, tiled kernels only; set by --tile-stats, not tuned
+
+    // Pixels covered by one workgroup along x and y
+    uint32_t spanX() const { return workgroupX * pixelsPerThread; }
+    uint32_t spanY() const { return workgroupY; }
+
+    std::string describe() const;
+};
+
+// Specialization info pointing at `config`, which has to outlive pipeline creation
+VkSpecializationInfo kernelSpecializationInfo(const KernelConfig& config);
+
+// Configurations worth benchmarking for a kernel ("naive", "depth", "tiled" or "subgroup"),
+// limited to what the device supports. The default configuration comes first.
+std::vector<KernelConfig> kernelConfigCandidates(const std::string& kernel, const VkPhysicalDeviceLimits& limits);
+
+// Tuned configurations live in the working directory, one file per device UUID
+// with a "<kernel> workgroupX workgroupY pixelsPerThread batchSize" line per kernel.
+std::string kernelConfigPath(const std::string& deviceUUID);
+bool loadKernelConfig(const std::string& path, const std::string& kernel, KernelConfig& config);
+// Replaces the kernel's line and keeps those of the other kernels
+void saveKernelConfig(const std::string& path, const std::string& kernel, const KernelConfig& config);
@@ -1,4 +1,15 @@
 #include "vulkan_setup.hpp"
+#include "file_loader.hpp"
+#include "gpu_preprocess.hpp"
+#include "scene_registry.hpp"
+#include "streaming_uploader.hpp"
+#include "gpu_tile_binning.hpp"
+#include "gpu_profiler.hpp"
+#include "kernel_config.hpp"
+#include "render_context.hpp"
+#include "batch_context.hpp"
+#include "transient_buffer_pool.hpp"
+#include "tile_stats.hpp"
 #include "utils.hpp"
 #include <cstring>
 #include <iostream>
@@ -8,204 +19,850 @@
 #include <fstream>
 #include <sstream>
 #include <cstddef> 
+#include <algorithm>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <future>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
-struct Gaussian {
-    float x, y;                 // Point position
-    float r, g, b;              // RGB colors
-    float ic11, ic12, ic21, ic22; // Inverse covariance matrix
-    float opacity;              // Opacity
-    float min_x, max_x, min_y, max_y; // Bounding ranges
-};
-
 struct PushConstants {
     int width;
     int height;
+    int regionX, regionY;           // Top-left corner of the render rectangle
+    int regionWidth, regionHeight;  // Size of the render rectangle
+    int outputDepth;                // Depth/alpha shader only: 1 = expected depth, 0 = accumulated alpha
 };
 
-std::vector<std::vector<float>> readCSV(const std::string& filename) {
-    std::vector<std::vector<float>> data;
-    std::ifstream file(filename);
+enum class RenderMode {
+    Color,  // RGBA color (compute_shader.glsl)
+    Depth,  // Expected depth per pixel (depth_shader.glsl)
+    Alpha   // Accumulated opacity per pixel (depth_shader.glsl)
+};
 
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file: " + filename);
+// Gaussian storage and arithmetic of the naive color kernel
+enum class Precision {
+    Full,       // 56-byte fp32 records (compute_shader.glsl)
+    Half,       // 32-byte HalfGaussian records, fp32 arithmetic (compute_shader_fp16.glsl)
+    HalfMath    // HalfGaussian records read as fp16 through 16-bit storage, fp16 Gaussian evaluation
+};
+
+enum class KernelType {
+    Naive,  // Every pixel walks every Gaussian (compute_shader.glsl)
+    Tiled,  // Every 16x16 tile walks its own Gaussian list in shared-memory batches (tile_shader.glsl)
+    Subgroup // Tiled, with subgroup votes for early exit and batch culling (tile_subgroup_shader.glsl)
+};
+
+// Gaussians binned to the 16x16 tiles of the render region, for the tiled kernel
+struct TileBins {
+    std::vector<uint32_t> gaussianIndices;  // Indices grouped by tile, depth order kept within a tile
+    std::vector<uint32_t> ranges;           // [start, end) into gaussianIndices, two entries per tile
+    std::vector<uint32_t> activeTiles;      // Tiles with at least one Gaussian, one workgroup each
+    int tilesX = 0, tilesY = 0;
+};
+
+// Sub-rectangle of the image to render. Defaults to the full image.
+struct RenderRegion {
+    int x, y;
+    int width, height;
+};
+
+// Input: either preprocessed 2D Gaussians (CSV) or a 3D scene preprocessed on the GPU
+struct SceneOptions {
+    std::string csvFile = "../processed_scene.csv";
+    std::vector<std::string> sceneFiles;        // 16-float records; enables GPU preprocessing
+    std::string cameraFile = "../camera.bin";   // camera.bin or trajectory, used with sceneFiles
+    uint32_t maxTilePairs = 0;                  // GPU binning capacity, 0 = 8 per Gaussian
+};
+
+struct BatchOptions {
+    int frameCount = 1;  // Frames to render
+    int slotCount = 2;   // Output buffers in flight
+};
+
+// Output buffer and command buffers for one frame in flight (owned by the BatchContext).
+// Frames are ordered by the batch's timeline semaphores; the fence is only used by the
+// blocking autotune runs.
+struct FrameSlot : BatchSlot {
+    std::vector<RenderRegion> viewRegions; // Region rendered by each view of the frame in flight
+    int frameIndex = -1;  // Frame currently in flight in this slot, -1 if idle
+};
+
+// Host-side time spent in each stage of a frame, in milliseconds
+struct FrameTiming {
+    double submitMs = 0.0;
+    double waitMs = 0.0;
+    double readbackMs = 0.0;
+    double encodeMs = 0.0;
+};
+
+// Wall time of the startup phases, in milliseconds. Scene decoding, shader reads and the
+// splatting pipeline run on worker threads; the waits are how long the main thread blocked on them.
+struct StartupTiming {
+    double deviceMs = 0.0;            // VulkanSetup construction
+    double sceneDecodeMs = 0.0;       // Summed over the decode workers
+    double sceneWaitMs = 0.0;
+    double splatPipelineMs = 0.0;     // On its worker
+    double splatPipelineWaitMs = 0.0;
+};
+
+// A --scene file, or the CSV's 2D Gaussians and depths, decoded on a startup worker
+struct DecodedScene {
+    std::vector<SceneGaussian> scene;
+    std::vector<Gaussian> gaussians;
+    std::vector<float> depths;
+    double decodeMs = 0.0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// The part of `region` inside a width x height image
+RenderRegion clampRegion(const RenderRegion& region, int width, int height) {
+    int x0 = std::max(region.x, 0);
+    int y0 = std::max(region.y, 0);
+    int x1 = std::min(region.x + region.width, width);
+    int y1 = std::min(region.y + region.height, height);
+    if (x1 <= x0 || y1 <= y0) {
+        throw std::runtime_error("Render region does not overlap the image!");
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::vector<float> row;
-        std::stringstream lineStream(line);
-        std::string cell;
+    return RenderRegion{x0, y0, x1 - x0, y1 - y0};
+}
+
+// Parses "--roi x y w h" from the command line and clamps it to the image.
+RenderRegion parseRenderRegion(int argc, char** argv, int width, int height) {
+    RenderRegion region = {0, 0, width, height};
 
-        while (std::getline(lineStream, cell, ',')) {
-            row.push_back(std::stof(cell)); // Convert each value to float
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) != "--roi") {
+            continue;
+        }
+        if (i + 4 >= argc) {
+            throw std::runtime_error("--roi expects 4 values: x y width height");
         }
+        region.x = std::stoi(argv[i + 1]);
+        region.y = std::stoi(argv[i + 2]);
+        region.width = std::stoi(argv[i + 3]);
+        region.height = std::stoi(argv[i + 4]);
+        i += 4;
+    }
+
+    return clampRegion(region, width, height);
+}
 
-        data.push_back(row);
+// Parses "--frames N" (frames to render) and "--slots N" (output buffers in flight).
+BatchOptions parseBatchOptions(int argc, char** argv, int defaultFrameCount = 1) {
+    BatchOptions options;
+    options.frameCount = defaultFrameCount;
+
+    for (int i = 1; i + 1 < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--frames") {
+            options.frameCount = std::stoi(argv[++i]);
+        } else if (arg == "--slots") {
+            options.slotCount = std::stoi(argv[++i]);
+        }
     }
 
-    file.close();
-    return data;
+    if (options.frameCount < 1 || options.slotCount < 1) {
+        throw std::runtime_error("--frames and --slots must be at least 1");
+    }
+
+    return options;
 }
 
-std::vector<Gaussian> loadGaussianCSV(const std::string& filename) {
-    std::vector<Gaussian> gaussians;
-    auto data = readCSV(filename); // Use the generic CSV reader
+// Parses "--scene file" (repeatable), "--camera file" and "--max-pairs n".
+SceneOptions parseSceneOptions(int argc, char** argv) {
+    SceneOptions options;
+
+    for (int i = 1; i + 1 < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--scene") {
+            options.sceneFiles.push_back(argv[++i]);
+        } else if (arg == "--camera") {
+            options.cameraFile = argv[++i];
+        } else if (arg == "--max-pairs") {
+            options.maxTilePairs = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+    }
 
-    for (const auto& row : data) {
-        if (row.size() != 14) { // Ensure correct number of columns
-            std::cerr << "Invalid row size: " << row.size() << "\n";
+    return options;
+}
+
+RenderMode parseRenderMode(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) != "--mode") {
             continue;
         }
+        std::string mode = argv[i + 1];
+        if (mode == "color") return RenderMode::Color;
+        if (mode == "depth") return RenderMode::Depth;
+        if (mode == "alpha") return RenderMode::Alpha;
+        throw std::runtime_error("Unknown --mode " + mode + " (expected color, depth or alpha)");
+    }
+    return RenderMode::Color;
+}
 
-        // Map row to Gaussian structure
-        gaussians.push_back(Gaussian{
-            row[0], row[1],  // x, y
-            row[2], row[3], row[4], // r, g, b
-            row[5], row[6], row[7], row[8], // ic11, ic12, ic21, ic22
-            row[9],          // opacity
-            row[10], row[11], row[12], row[13] // min_x, max_x, min_y, max_y
-        });
+KernelType parseKernelType(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) != "--kernel") {
+            continue;
+        }
+        std::string kernel = argv[i + 1];
+        if (kernel == "naive") return KernelType::Naive;
+        if (kernel == "tiled") return KernelType::Tiled;
+        if (kernel == "subgroup") return KernelType::Subgroup;
+        throw std::runtime_error("Unknown --kernel " + kernel + " (expected naive, tiled or subgroup)");
     }
+    return KernelType::Naive;
+}
 
-    return gaussians;
+Precision parsePrecision(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) != "--precision") {
+            continue;
+        }
+        std::string precision = argv[i + 1];
+        if (precision == "full") return Precision::Full;
+        if (precision == "half") return Precision::Half;
+        if (precision == "half-math") return Precision::HalfMath;
+        throw std::runtime_error("Unknown --precision " + precision + " (expected full, half or half-math)");
+    }
+    return Precision::Full;
 }
 
-void checkCPUMemoryAlignment() {
-    std::cout << "Offsets in C++ Gaussian struct:\n";
-    std::cout << "x: " << offsetof(Gaussian, x) << "\n";
-    std::cout << "y: " << offsetof(Gaussian, y) << "\n";
-    std::cout << "r: " << offsetof(Gaussian, r) << "\n";
-    std::cout << "g: " << offsetof(Gaussian, g) << "\n";
-    std::cout << "b: " << offsetof(Gaussian, b) << "\n";
-    std::cout << "ic11: " << offsetof(Gaussian, ic11) << "\n";
-    std::cout << "opacity: " << offsetof(Gaussian, opacity) << "\n";
-    std::cout << "min_x: " << offsetof(Gaussian, min_x) << "\n";
+// "--compare-precision" renders one frame at every precision and reports the error against fp32
+bool parseComparePrecision(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--compare-precision") {
+            return true;
+        }
+    }
+    return false;
+}
 
-    std::cout << "Total size of struct: " << sizeof(Gaussian) << " bytes\n";
+// "--autotune" benchmarks the kernel configurations before rendering and saves the fastest
+bool parseAutotune(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--autotune") {
+            return true;
+        }
+    }
+    return false;
 }
 
-int main() {
-    try {
-        checkCPUMemoryAlignment();
+// --persistent without --persistent-groups: the count is estimated for the device
+constexpr uint32_t AUTO_PERSISTENT_GROUPS = UINT32_MAX;
+
+// Parses "--persistent" (persistent-threads dispatch of the tiled kernels) and
+// "--persistent-groups N" (workgroups to launch). Returns 0 without --persistent, and
+// AUTO_PERSISTENT_GROUPS when the count is left to estimatePersistentGroups.
+uint32_t parsePersistentGroups(int argc, char** argv) {
+    bool persistent = false;
+    uint32_t groups = AUTO_PERSISTENT_GROUPS;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--persistent") {
+            persistent = true;
+        } else if (arg == "--persistent-groups" && i + 1 < argc) {
+            groups = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+    }
+
+    if (persistent && groups == 0) {
+        throw std::runtime_error("--persistent-groups must be at least 1");
+    }
+    return persistent ? groups : 0;
+}
+
+// Workgroups of the tiled kernels the device keeps resident at once: its compute units times
+// the 16x16 workgroups each one holds, limited by the unit's subgroup slots and by shared
+// memory (maxComputeSharedMemorySize stands in for the per-unit amount, which has no query).
+// Without a vendor query for the compute units it falls back to 256, enough for current
+// desktop GPUs.
+uint32_t estimatePersistentGroups(const VulkanSetup& vulkan, const KernelConfig& config) {
+    const uint32_t fallbackGroups = 256;
+    const VulkanSetup::ComputeUnits units = vulkan.getComputeUnits();
+    if (units.count == 0) {
+        return fallbackGroups;
+    }
+
+    // tile_shader.glsl: position, conic/opacity, color (padded to 16 bytes) and bounds per
+    // batch entry, plus the --tile-stats bits and a few counters
+    const uint32_t sharedBytes = config.batchSize * (8 + 16 + 16 + 16) + ((config.batchSize + 31) / 32 + 4) * 4;
+    uint32_t groupsPerUnit = std::max(1u, vulkan.getDeviceLimits().maxComputeSharedMemorySize / sharedBytes);
+
+    const uint32_t subgroupSize = vulkan.getSubgroupSize();
+    if (units.residentSubgroups > 0 && subgroupSize > 0) {
+        const uint32_t subgroupsPerGroup = (16 * 16 + subgroupSize - 1) / subgroupSize;
+        groupsPerUnit = std::min(groupsPerUnit, std::max(1u, units.residentSubgroups / subgroupsPerGroup));
+    }
+    return units.count * groupsPerUnit;
+}
+
+// Parses "--views K": preprocess, bin and splat the first K cameras in one command
+// buffer per frame, into a layered readback buffer. 1 (the default) renders one view.
+uint32_t parseViewCount(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--views") {
+            uint32_t views = static_cast<uint32_t>(std::stoul(argv[i + 1]));
+            if (views == 0) {
+                throw std::runtime_error("--views must be at least 1");
+            }
+            return views;
+        }
+    }
+    return 1;
+}
+
+// Parses "--trajectory": frames walk through the cameras of --camera, frame f rendering
+// cameras f*K .. f*K+K-1 (K = --views, wrapping around), each preprocessed, binned and
+// sorted for its own view. --frames then defaults to one pass over the cameras.
+bool parseTrajectory(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--trajectory") {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parses "--context-renders N": render the first camera N times through one
+// RenderContext and report the latency of each render. 0 (the default) is off.
+uint32_t parseContextRenders(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--context-renders") {
+            return static_cast<uint32_t>(std::stoul(argv[i + 1]));
+        }
+    }
+    return 0;
+}
+
+// Parses "--stream" and "--stream-chunk-mb N": upload the scenes in chunks of N MiB
+// (default 8) while the first frames render. Returns the chunk size in bytes, 0 when off.
+VkDeviceSize parseStreamChunkSize(int argc, char** argv) {
+    bool stream = false;
+    VkDeviceSize chunkMB = 8;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stream") {
+            stream = true;
+        } else if (arg == "--stream-chunk-mb" && i + 1 < argc) {
+            chunkMB = std::stoull(argv[++i]);
+            stream = true;
+        }
+    }
+
+    if (stream && chunkMB == 0) {
+        throw std::runtime_error("--stream-chunk-mb must be at least 1");
+    }
+    return stream ? chunkMB << 20 : 0;
+}
+
+// Orders a scene nearest first for `camera`, so a streamed upload delivers the Gaussians
+// that cover most of the first view (and come first in the blend) before the far ones.
+void orderForStreaming(std::vector<SceneGaussian>& scene, const Camera& camera) {
+    // Camera position -R^T t from the column-major view matrix
+    float eye[3];
+    for (int j = 0; j < 3; ++j) {
+        eye[j] = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            eye[j] -= camera.view[j * 4 + i] * camera.view[12 + i];
+        }
+    }
+
+    auto distance2 = [&](const SceneGaussian& g) {
+        float dx = g.position[0] - eye[0];
+        float dy = g.position[1] - eye[1];
+        float dz = g.position[2] - eye[2];
+        return dx * dx + dy * dy + dz * dz;
+    };
+    std::stable_sort(scene.begin(), scene.end(), [&](const SceneGaussian& a, const SceneGaussian& b) {
+        return distance2(a) < distance2(b);
+    });
+}
+
+// Drops Gaussians whose bounding box misses the render region. Depth order is preserved,
+// and `depths` (if given) is filtered alongside.
+std::vector<Gaussian> cullToRegion(const std::vector<Gaussian>& gaussians, const RenderRegion& region,
+                                   std::vector<float>* depths = nullptr) {
+    const float regionMaxX = static_cast<float>(region.x + region.width - 1);
+    const float regionMaxY = static_cast<float>(region.y + region.height - 1);
+
+    std::vector<Gaussian> culled;
+    std::vector<float> culledDepths;
+    culled.reserve(gaussians.size());
+    for (size_t i = 0; i < gaussians.size(); ++i) {
+        const auto& g = gaussians[i];
+        if (g.max_x < region.x || g.min_x > regionMaxX ||
+            g.max_y < region.y || g.min_y > regionMaxY) {
+            continue;
+        }
+        culled.push_back(g);
+        if (depths) {
+            culledDepths.push_back((*depths)[i]);
+        }
+    }
+
+    if (depths) {
+        *depths = std::move(culledDepths);
+    }
+    return culled;
+}
+
+// Assigns every Gaussian to the tiles its bounding box touches. Tiles are laid out
+// row-major over the render region, matching the workgroup grid of the dispatch.
+TileBins binToTiles(const std::vector<Gaussian>& gaussians, const RenderRegion& region) {
+    const int tileSize = 16;
+
+    TileBins bins;
+    bins.tilesX = (region.width + tileSize - 1) / tileSize;
+    bins.tilesY = (region.height + tileSize - 1) / tileSize;
+    const size_t tileCount = static_cast<size_t>(bins.tilesX) * bins.tilesY;
+
+    // Tile rectangle touched by a Gaussian, clamped to the grid; empty if it misses
+    auto tileRect = [&](const Gaussian& g, int& tx0, int& tx1, int& ty0, int& ty1) {
+        tx0 = std::max(static_cast<int>(std::floor((g.min_x - region.x) / tileSize)), 0);
+        tx1 = std::min(static_cast<int>(std::floor((g.max_x - region.x) / tileSize)), bins.tilesX - 1);
+        ty0 = std::max(static_cast<int>(std::floor((g.min_y - region.y) / tileSize)), 0);
+        ty1 = std::min(static_cast<int>(std::floor((g.max_y - region.y) / tileSize)), bins.tilesY - 1);
+    };
+
+    // Count, prefix sum, then fill in Gaussian order so each tile stays depth sorted
+    std::vector<uint32_t> counts(tileCount, 0);
+    int tx0, tx1, ty0, ty1;
+    for (const auto& g : gaussians) {
+        tileRect(g, tx0, tx1, ty0, ty1);
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                counts[ty * bins.tilesX + tx]++;
+            }
+        }
+    }
+
+    bins.ranges.resize(tileCount * 2);
+    uint32_t offset = 0;
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        bins.ranges[tile * 2] = offset;
+        offset += counts[tile];
+        bins.ranges[tile * 2 + 1] = offset;
+        if (counts[tile] > 0) {
+            bins.activeTiles.push_back(static_cast<uint32_t>(tile));
+        }
+    }
+
+    bins.gaussianIndices.resize(offset);
+    std::vector<uint32_t> cursor(tileCount);
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        cursor[tile] = bins.ranges[tile * 2];
+    }
+    for (uint32_t i = 0; i < gaussians.size(); ++i) {
+        tileRect(gaussians[i], tx0, tx1, ty0, ty1);
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                bins.gaussianIndices[cursor[ty * bins.tilesX + tx]++] = i;
+            }
+        }
+    }
+
+    return bins;
+}
+
+// Bounding box coordinate as a whole pixel, saturated to int16
+int16_t toPixelBound(float value) {
+    return static_cast<int16_t>(std::min(std::max(value, -32768.0f), 32767.0f));
+}
+
+// Packs the Gaussians for depth_shader.glsl, with the bounds rounded inwards like toHalfGaussians
+std::vector<DepthGaussian> toDepthGaussians(const std::vector<Gaussian>& gaussians, const std::vector<float>& depths) {
+    std::vector<DepthGaussian> reduced;
+    reduced.reserve(gaussians.size());
+    for (size_t i = 0; i < gaussians.size(); ++i) {
+        const auto& g = gaussians[i];
+        reduced.push_back(DepthGaussian{g.x, g.y, g.ic11, g.ic12, g.ic22, g.opacity, depths[i],
+                                        toPixelBound(std::ceil(g.min_x)), toPixelBound(std::floor(g.max_x)),
+                                        toPixelBound(std::ceil(g.min_y)), toPixelBound(std::floor(g.max_y))});
+    }
+    return reduced;
+}
+
+// IEEE 754 binary16 bits of `value`, rounded to nearest even
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t floatExponent = (bits >> 23) & 0xff;
+    const int32_t exponent = static_cast<int32_t>(floatExponent) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (floatExponent == 0xff) {
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0)); // Inf or NaN
+    }
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00); // Overflow to infinity
+    }
+
+    uint32_t shift = 13;
+    uint32_t half = (static_cast<uint32_t>(std::max(exponent, 0)) << 10);
+    if (exponent <= 0) {
+        // Subnormal half: shift the mantissa, implicit bit included, below the exponent field
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000;
+        shift = 14 - exponent;
+    }
+    half |= mantissa >> shift;
+
+    // A carry out of the mantissa correctly bumps the exponent
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1))) {
+        ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+// Packs the Gaussians for compute_shader_fp16.glsl. The bounds are rounded inwards to whole
+// pixels, which keeps the bounding box test exact since pixels sit on integer coordinates.
+std::vector<HalfGaussian> toHalfGaussians(const std::vector<Gaussian>& gaussians) {
+    std::vector<HalfGaussian> packed;
+    packed.reserve(gaussians.size());
+    for (const auto& g : gaussians) {
+        HalfGaussian h = {};
+        h.x = g.x;
+        h.y = g.y;
+        h.r = floatToHalf(g.r);
+        h.g = floatToHalf(g.g);
+        h.b = floatToHalf(g.b);
+        h.opacity = floatToHalf(g.opacity);
+        h.conic_a = floatToHalf(g.ic11);
+        h.conic_b = floatToHalf(g.ic12 + g.ic21);
+        h.conic_c = floatToHalf(g.ic22);
+        h.min_x = toPixelBound(std::ceil(g.min_x));
+        h.max_x = toPixelBound(std::floor(g.max_x));
+        h.min_y = toPixelBound(std::ceil(g.min_y));
+        h.max_y = toPixelBound(std::floor(g.max_y));
+        packed.push_back(h);
+    }
+    return packed;
+}
+
+double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::vector<uint8_t> convertToRGBA8(const float* imageData, const RenderRegion& region) {
+    const size_t pixelCount = static_cast<size_t>(region.width) * region.height;
+    std::vector<uint8_t> pixelData(pixelCount * 4); // RGBA output
+    for (size_t i = 0; i < pixelCount; ++i) {
+        pixelData[i * 4 + 0] = static_cast<uint8_t>(imageData[i * 4 + 0] * 255.0f); // R
+        pixelData[i * 4 + 1] = static_cast<uint8_t>(imageData[i * 4 + 1] * 255.0f); // G
+        pixelData[i * 4 + 2] = static_cast<uint8_t>(imageData[i * 4 + 2] * 255.0f); // B
+        pixelData[i * 4 + 3] = 255; // A
+    }
+    return pixelData;
+}
+
+// Single-channel preview of a depth or alpha buffer. Depth is normalized by its maximum.
+std::vector<uint8_t> convertToGray8(const float* values, const RenderRegion& region, RenderMode mode) {
+    const size_t pixelCount = static_cast<size_t>(region.width) * region.height;
+
+    float scale = 1.0f;
+    if (mode == RenderMode::Depth) {
+        float maxDepth = 0.0f;
+        for (size_t i = 0; i < pixelCount; ++i) {
+            maxDepth = std::max(maxDepth, values[i]);
+        }
+        scale = maxDepth > 0.0f ? 1.0f / maxDepth : 0.0f;
+    }
+
+    std::vector<uint8_t> pixelData(pixelCount);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        pixelData[i] = static_cast<uint8_t>(std::min(values[i] * scale, 1.0f) * 255.0f);
+    }
+    return pixelData;
+}
+
+// Output file name without extension
+std::string outputFilename(int frame, int frameCount) {
+    if (frameCount == 1) {
+        return "output";
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "output_%04d", frame);
+    return name;
+}
+
+// Per-stage averages. With more than one slot, "wait" should drop well below the
+// dispatch time because the GPU works on the next frame while the host encodes.
+void printTimingSummary(const std::vector<FrameTiming>& timings, double batchMs, uint32_t slotCount) {
+    FrameTiming total;
+    for (const auto& t : timings) {
+        total.submitMs += t.submitMs;
+        total.waitMs += t.waitMs;
+        total.readbackMs += t.readbackMs;
+        total.encodeMs += t.encodeMs;
+    }
+    const double n = static_cast<double>(timings.size());
+
+    std::cout << "Rendered " << timings.size() << " frame(s) with " << slotCount << " slot(s) in "
+              << batchMs << " ms (" << batchMs / n << " ms/frame)\n"
+              << "  avg record+submit: " << total.submitMs / n << " ms\n"
+              << "  avg GPU wait:      " << total.waitMs / n << " ms\n"
+              << "  avg readback:      " << total.readbackMs / n << " ms\n"
+              << "  avg encode:        " << total.encodeMs / n << " ms" << std::endl;
+}
 
-        VulkanSetup vulkan;
+// One GPU interval of the --trace output, in microseconds
+struct TraceSpan {
+    std::string name;
+    uint32_t queue; // 0 compute, 1 transfer
+    double startUs;
+    double endUs;
+};
+
+// Parses "--trace file.json" (empty when not requested).
+std::string parseTraceFile(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--trace") {
+            return argv[i + 1];
+        }
+    }
+    return "";
+}
+
+// Parses "--profile file.csv" or "--profile file.json" (empty when not requested).
+std::string parseProfileFile(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--profile") {
+            return argv[i + 1];
+        }
+    }
+    return "";
+}
+
+// Parses "--tile-stats prefix": count the tiled kernel's per-tile work and write the last
+// frame's heatmaps to prefix_visited.png, prefix_contributed.png and prefix_saturation.png
+// (empty when not requested).
+std::string parseTileStatsPrefix(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--tile-stats") {
+            return argv[i + 1];
+        }
+    }
+    return "";
+}
+
+// Writes the spans in the Chrome trace event format (chrome://tracing, Perfetto), one
+// track per queue, and prints how long the transfer queue ran alongside compute work.
+void writeQueueTrace(const std::string& path, std::vector<TraceSpan> spans) {
+    if (spans.empty()) {
+        return;
+    }
 
-        // Data setup
-        const int width = 5068;
-        const int height = 3326;
+    double origin = spans[0].startUs;
+    for (const auto& span : spans) {
+        origin = std::min(origin, span.startUs);
+    }
 
-        std::vector<Gaussian> gaussians = loadGaussianCSV("../processed_scene.csv");
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to write trace: " + path);
+    }
+    file << "{\"traceEvents\": [\n"
+         << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"compute queue\"}},\n"
+         << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"transfer queue\"}}";
+    for (const auto& span : spans) {
+        file << ",\n  {\"name\": \"" << span.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << span.queue
+             << ", \"ts\": " << span.startUs - origin << ", \"dur\": " << span.endUs - span.startUs << "}";
+    }
+    file << "\n]}\n";
 
-        for (size_t i = 0; i < 5 && i < gaussians.size(); ++i) {
-            const auto& g = gaussians[i];
-            std::cout << "Gaussian " << i << ": "
-                    << "x=" << g.x << ", y=" << g.y
-                    << ", r=" << g.r << ", g=" << g.g << ", b=" << g.b
-                    << ", ic11=" << g.ic11 << ", ic12=" << g.ic12
-                    << ", ic21=" << g.ic21 << ", ic22=" << g.ic22
-                    << ", opacity=" << g.opacity
-                    << ", min_x=" << g.min_x << ", max_x=" << g.max_x
-                    << ", min_y=" << g.min_y << ", max_y=" << g.max_y
-                    << std::endl;
+    double transferUs = 0.0;
+    double overlapUs = 0.0;
+    for (const auto& transfer : spans) {
+        if (transfer.queue != 1) {
+            continue;
         }
+        transferUs += transfer.endUs - transfer.startUs;
+        for (const auto& compute : spans) {
+            if (compute.queue == 0) {
+                overlapUs += std::max(0.0, std::min(transfer.endUs, compute.endUs) - std::max(transfer.startUs, compute.startUs));
+            }
+        }
+    }
+
+    std::cout << "Queue trace written to " << path;
+    if (transferUs > 0.0) {
+        std::cout << ": readback copies overlapped compute work for " << overlapUs / 1000.0
+                  << " of " << transferUs / 1000.0 << " ms";
+    }
+    std::cout << std::endl;
+}
+
+// Splatting kernel of a run
+std::string splatShaderFile(KernelType kernel, bool colorMode, Precision precision) {
+    if (kernel == KernelType::Subgroup) {
+        return "../shaders/tile_subgroup_shader.spv";
+    } else if (kernel == KernelType::Tiled) {
+        return "../shaders/tile_shader.spv";
+    } else if (!colorMode) {
+        return "../shaders/depth_shader.spv";
+    } else if (precision == Precision::Half) {
+        return "../shaders/compute_shader_fp16.spv";
+    } else if (precision == Precision::HalfMath) {
+        return "../shaders/compute_shader_fp16_math.spv";
+    }
+    return "../shaders/compute_shader.spv";
+}
+
+// SPIR-V the command line is expected to load, read by VulkanSetup while it creates the
+// device. Only a hint: device fallbacks (--kernel subgroup, --precision half-math) may
+// pick other files, which are then read when they are used.
+std::vector<std::string> startupShaderFiles(int argc, char** argv) {
+    const std::vector<std::string> sortShaders = {"../shaders/sort_setup.spv", "../shaders/sort_histogram.spv",
+        "../shaders/sort_scatter.spv", "../shaders/prefix_scan.spv", "../shaders/prefix_add.spv"};
+    const KernelType kernel = parseKernelType(argc, argv);
+    std::vector<std::string> files = {splatShaderFile(kernel, parseRenderMode(argc, argv) == RenderMode::Color,
+                                                      parsePrecision(argc, argv))};
+    if (kernel == KernelType::Subgroup) {
+        files.push_back(splatShaderFile(KernelType::Tiled, true, Precision::Full));
+    }
+    if (!parseSceneOptions(argc, argv).sceneFiles.empty()) {
+        files.push_back("../shaders/preprocess_shader.spv");
+        if (kernel != KernelType::Naive) {
+            files.insert(files.end(), sortShaders.begin(), sortShaders.end());
+            for (const char* binningShader : {"tile_count", "tile_duplicate", "tile_ranges", "tile_setup"}) {
+                files.push_back(std::string("../shaders/") + binningShader + ".spv");
+            }
+            if (parsePersistentGroups(argc, argv) > 0) {
+                files.push_back("../shaders/tile_cost.spv");
+            }
+        }
+    }
+    return files;
+}
+
+// Decodes the --scene files (or the CSV without them) on worker threads, one per file,
+// so they are parsed while the device is created
+std::vector<std::future<DecodedScene>> startSceneDecoding(const SceneOptions& options) {
+    std::vector<std::future<DecodedScene>> decodes;
+    if (options.sceneFiles.empty()) {
+        decodes.push_back(std::async(std::launch::async, [file = options.csvFile]() {
+            auto start = Clock::now();
+            DecodedScene decoded;
+            decoded.gaussians = loadGaussianCSV(file, &decoded.depths);
+            decoded.decodeMs = elapsedMs(start, Clock::now());
+            return decoded;
+        }));
+    }
+    for (const auto& sceneFile : options.sceneFiles) {
+        decodes.push_back(std::async(std::launch::async, [file = sceneFile]() {
+            auto start = Clock::now();
+            DecodedScene decoded;
+            decoded.scene = loadSceneBinary(file);
+            decoded.decodeMs = elapsedMs(start, Clock::now());
+            return decoded;
+        }));
+    }
+    return decodes;
+}
+
+// Waits for a decode worker (rethrowing its error) and adds it to the startup report
+DecodedScene takeDecodedScene(std::future<DecodedScene>& decode, StartupTiming& startup) {
+    auto waitStart = Clock::now();
+    DecodedScene decoded = decode.get();
+    startup.sceneWaitMs += elapsedMs(waitStart, Clock::now());
+    startup.sceneDecodeMs += decoded.decodeMs;
+    return decoded;
+}
 
-        VkDeviceSize gaussianBufferSize = sizeof(Gaussian) * gaussians.size();
+void printStartupReport(const StartupTiming& startup, const VulkanSetup::StartupTimes& device, double totalMs) {
+    std::cout << "Startup: " << totalMs << " ms to the first frame" << std::endl;
+    std::cout << "  device " << startup.deviceMs << " ms (instance " << device.instanceMs << ", device "
+              << device.deviceMs << ", arena/cache/pools " << device.resourcesMs << ")" << std::endl;
+    std::cout << "  shader reads " << device.shaderReadMs << " ms for " << device.prefetchedShaders
+              << " prefetched files, during device creation" << std::endl;
+    std::cout << "  scene decode " << startup.sceneDecodeMs << " ms on worker threads, waited "
+              << startup.sceneWaitMs << " ms" << std::endl;
+    std::cout << "  splatting pipeline " << startup.splatPipelineMs << " ms on a worker thread, waited "
+              << startup.splatPipelineWaitMs << " ms" << std::endl;
+}
+
+// Renders the region once with the naive color kernel at every precision the device
+// supports and compares each image to the fp32 one: largest and mean absolute error,
+// PSNR of the colors clamped to [0, 1], and 8-bit output values that changed.
+void runPrecisionComparison(VulkanSetup& vulkan, const std::vector<Gaussian>& gaussians, const RenderRegion& region,
+                            const PushConstants& pc) {
+    const std::vector<HalfGaussian> halfGaussians = toHalfGaussians(gaussians);
+    const VkDeviceSize imageSize = static_cast<VkDeviceSize>(region.width) * region.height * 4 * sizeof(float);
+
+    VkDescriptorSetLayoutBinding bindings[2] = {};
+    for (uint32_t i = 0; i < 2; ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor set layout!");
+    }
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    VkPipelineLayout pipelineLayout;
+    if (vkCreatePipelineLayout(vulkan.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
 
-        // Create a buffer for Gaussian data
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 2;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    VkDescriptorPool descriptorPool;
+    if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor pool!");
+    }
+
+    VkBuffer imageBuffer, readbackBuffer;
+    vulkan.createBuffer(imageSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, imageBuffer);
+    vulkan.createReadbackBuffer(imageSize, readbackBuffer);
+
+    // One blocking render of the region, returning the RGBA floats and the GPU time
+    auto render = [&](const std::string& shaderFile, const void* data, VkDeviceSize dataSize, double& renderMs) {
         VkBuffer gaussianBuffer;
-        VkDeviceMemory gaussianBufferMemory;
-        vulkan.createBuffer(gaussianBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            gaussianBuffer, gaussianBufferMemory);
-
-        // Copy data to input buffer
-        void* data;
-        vkMapMemory(vulkan.device, gaussianBufferMemory, 0, gaussianBufferSize, 0, &data);
-        std::memcpy(data, gaussians.data(), gaussianBufferSize);
-        vkUnmapMemory(vulkan.device, gaussianBufferMemory);
-
-        std::cout << "Input buffers created and data uploaded." << std::endl;
-
-        // read back and verify uploaded data
-        void* verifyData;
-        vkMapMemory(vulkan.device, gaussianBufferMemory, 0, gaussianBufferSize, 0, &verifyData);
-        std::vector<Gaussian> uploadedData(gaussians.size());
-        std::memcpy(uploadedData.data(), verifyData, gaussianBufferSize);
-        vkUnmapMemory(vulkan.device, gaussianBufferMemory);
-
-        for (size_t i = 0; i < 5; ++i) {
-            const auto& g = uploadedData[i];
-            std::cout << "Uploaded Gaussian " << i << ": "
-                    << "x=" << g.x << ", y=" << g.y
-                    << ", r=" << g.r << ", g=" << g.g << ", b=" << g.b
-                    << ", ic11=" << g.ic11 << ", ic12=" << g.ic12
-                    << ", ic21=" << g.ic21 << ", ic22=" << g.ic22
-                    << ", opacity=" << g.opacity
-                    << ", min_x=" << g.min_x << ", max_x=" << g.max_x
-                    << ", min_y=" << g.min_y << ", max_y=" << g.max_y
-                    << std::endl;
-        }
-
-        // Output image buffer
-        VkDeviceSize imageBufferSize = width * height * sizeof(float) * 4; // RGBA
-        VkBuffer imageBuffer;
-        VkDeviceMemory imageBufferMemory;
-        vulkan.createBuffer(imageBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            imageBuffer, imageBufferMemory);
-
-        std::cout << "output image buffer created successfully." << std::endl;
-
-        // load compute shader 
-        std::vector<char> computeShaderCode = readFile("../shaders/compute_shader.spv");
-        VkShaderModule computeShaderModule = vulkan.createShaderModule(computeShaderCode);
-        std::cout << "Shader module created." << std::endl;
-
-        // Descriptor set layout
-        VkDescriptorSetLayoutBinding gaussianBinding = {};
-        gaussianBinding.binding = 0;
-        gaussianBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        gaussianBinding.descriptorCount = 1;
-        gaussianBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-
-        VkDescriptorSetLayoutBinding imageBinding = {};
-        imageBinding.binding = 1;
-        imageBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        imageBinding.descriptorCount = 1;
-        imageBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-
-        std::array<VkDescriptorSetLayoutBinding, 2> bindings = {gaussianBinding, imageBinding};
-
-        VkDescriptorSetLayoutCreateInfo layoutInfo = {};
-        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layoutInfo.bindingCount = bindings.size();
-        layoutInfo.pBindings = bindings.data();
-
-        VkDescriptorSetLayout descriptorSetLayout;
-        if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create descriptor set layout!");
-        }
-
-        // Descriptor pool
-        VkDescriptorPoolSize poolSize = {};
-        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        poolSize.descriptorCount = 2;
-
-        VkDescriptorPoolCreateInfo poolInfo = {};
-        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.poolSizeCount = 1;
-        poolInfo.pPoolSizes = &poolSize;
-        poolInfo.maxSets = 1;
-
-        VkDescriptorPool descriptorPool;
-        if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create descriptor pool!");
-        }
-
-        // Allocate descriptor set
+        vulkan.createDeviceLocalBuffer(dataSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, data, gaussianBuffer);
+        VkPipeline pipeline = vulkan.createComputePipeline(shaderFile, pipelineLayout);
+
         VkDescriptorSetAllocateInfo allocInfo = {};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         allocInfo.descriptorPool = descriptorPool;
@@ -214,75 +871,649 @@ int main() {
 
         VkDescriptorSet descriptorSet;
         if (vkAllocateDescriptorSets(vulkan.device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to allocate descriptor set!");
+            throw std::runtime_error("Failed to allocate descriptor sets!");
+        }
+
+        VkDescriptorBufferInfo bufferInfos[2] = {{gaussianBuffer, 0, dataSize}, {imageBuffer, 0, imageSize}};
+        VkWriteDescriptorSet descriptorWrites[2] = {};
+        for (uint32_t i = 0; i < 2; ++i) {
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = descriptorSet;
+            descriptorWrites[i].dstBinding = i;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(vulkan.device, 2, descriptorWrites, 0, nullptr);
+
+        VkCommandBufferAllocateInfo commandInfo = {};
+        commandInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandInfo.commandPool = vulkan.commandPool;
+        commandInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        vkAllocateCommandBuffers(vulkan.device, &commandInfo, &commandBuffer);
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+        vkCmdDispatch(commandBuffer, (region.width + 15) / 16, (region.height + 15) / 16, 1);
+        vkEndCommandBuffer(commandBuffer);
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkFence fence;
+        vkCreateFence(vulkan.device, &fenceInfo, nullptr, &fence);
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+
+        auto start = Clock::now();
+        vkQueueSubmit(vulkan.computeQueue, 1, &submitInfo, fence);
+        vkWaitForFences(vulkan.device, 1, &fence, VK_TRUE, UINT64_MAX);
+        renderMs = elapsedMs(start, Clock::now());
+
+        vulkan.copyBuffer(imageBuffer, readbackBuffer, imageSize);
+        vulkan.invalidateBuffer(readbackBuffer);
+        std::vector<float> image(imageSize / sizeof(float));
+        std::memcpy(image.data(), vulkan.mapBuffer(readbackBuffer), imageSize);
+
+        vkDestroyFence(vulkan.device, fence, nullptr);
+        vkFreeCommandBuffers(vulkan.device, vulkan.commandPool, 1, &commandBuffer);
+        vkFreeDescriptorSets(vulkan.device, descriptorPool, 1, &descriptorSet);
+        vkDestroyPipeline(vulkan.device, pipeline, nullptr);
+        vulkan.destroyBuffer(gaussianBuffer);
+        return image;
+    };
+
+    double referenceMs = 0.0;
+    const std::vector<float> reference = render("../shaders/compute_shader.spv", gaussians.data(),
+                                                sizeof(Gaussian) * gaussians.size(), referenceMs);
+    const std::vector<uint8_t> reference8 = convertToRGBA8(reference.data(), region);
+    std::cout << "fp32: " << sizeof(Gaussian) << " bytes per splat, " << referenceMs << " ms" << std::endl;
+
+    std::vector<std::pair<std::string, std::string>> variants = {{"fp16 storage", "../shaders/compute_shader_fp16.spv"}};
+    if (vulkan.supportsHalfArithmetic()) {
+        variants.push_back({"fp16 arithmetic", "../shaders/compute_shader_fp16_math.spv"});
+    } else {
+        std::cout << "fp16 arithmetic: not supported by the device, skipped" << std::endl;
+    }
+
+    for (const auto& variant : variants) {
+        double renderMs = 0.0;
+        const std::vector<float> image = render(variant.second, halfGaussians.data(),
+                                                sizeof(HalfGaussian) * halfGaussians.size(), renderMs);
+        const std::vector<uint8_t> image8 = convertToRGBA8(image.data(), region);
+
+        double maxError = 0.0;
+        double errorSum = 0.0;
+        double squaredErrorSum = 0.0;
+        size_t channelCount = 0;
+        for (size_t i = 0; i < image.size(); i += 4) {
+            for (size_t c = 0; c < 3; ++c) {
+                double error = std::fabs(static_cast<double>(image[i + c]) - reference[i + c]);
+                double clampedError = std::fabs(std::min(std::max(static_cast<double>(image[i + c]), 0.0), 1.0) -
+                                                std::min(std::max(static_cast<double>(reference[i + c]), 0.0), 1.0));
+                maxError = std::max(maxError, error);
+                errorSum += error;
+                squaredErrorSum += clampedError * clampedError;
+                ++channelCount;
+            }
+        }
+        size_t changed8 = 0;
+        for (size_t i = 0; i < image8.size(); ++i) {
+            changed8 += image8[i] != reference8[i] ? 1 : 0;
         }
 
-        std::cout << "Descriptor set allocated successfully." << std::endl;
+        const double mse = squaredErrorSum / channelCount;
+        std::cout << variant.first << ": " << sizeof(HalfGaussian) << " bytes per splat, " << renderMs << " ms, "
+                  << "max error " << maxError << ", mean error " << errorSum / channelCount << ", PSNR ";
+        if (mse > 0.0) {
+            std::cout << 10.0 * std::log10(1.0 / mse) << " dB";
+        } else {
+            std::cout << "inf";
+        }
+        std::cout << ", " << changed8 << " of " << channelCount << " 8-bit values changed" << std::endl;
+    }
+
+    vulkan.destroyBuffer(readbackBuffer);
+    vulkan.destroyBuffer(imageBuffer);
+    vkDestroyDescriptorPool(vulkan.device, descriptorPool, nullptr);
+    vkDestroyPipelineLayout(vulkan.device, pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.device, descriptorSetLayout, nullptr);
+}
+
+// Renders `renderCount` times with a RenderContext, cycling through `cameras`, and writes
+// the last image to output.png. The first render builds the size-dependent buffers; the
+// others only record, submit and read back.
+void runContextRenders(VulkanSetup& vulkan, const SceneOptions& sceneOptions, std::vector<std::future<DecodedScene>>& sceneDecodes,
+                       const std::vector<Camera>& cameras, bool subgroupKernel, uint32_t renderCount) {
+    auto setupStart = Clock::now();
+    RenderContext context(vulkan, subgroupKernel, sceneOptions.maxTilePairs);
+    std::cout << "Render context created in " << elapsedMs(setupStart, Clock::now()) << " ms ("
+              << context.getKernelConfig().describe() << ")" << std::endl;
+
+    for (auto& decode : sceneDecodes) {
+        auto uploadStart = Clock::now();
+        uint32_t sceneIndex = context.addScene(decode.get().scene);
+        std::cout << "Scene " << sceneIndex << " loaded: " << context.getSceneRegistry().getGaussianCount(sceneIndex)
+                  << " Gaussians in " << elapsedMs(uploadStart, Clock::now()) << " ms" << std::endl;
+    }
 
-        // Descriptor buffer bindings
-        VkDescriptorBufferInfo gaussianBufferInfo = {};
-        gaussianBufferInfo.buffer = gaussianBuffer;
-        gaussianBufferInfo.offset = 0;
-        gaussianBufferInfo.range = gaussianBufferSize;
+    std::vector<float> image;
+    std::vector<double> renderMs(renderCount);
+    for (uint32_t i = 0; i < renderCount; ++i) {
+        auto renderStart = Clock::now();
+        context.render(0, cameras[i % cameras.size()], image);
+        renderMs[i] = elapsedMs(renderStart, Clock::now());
+        std::cout << "Render " << i << ": " << renderMs[i] << " ms" << std::endl;
+    }
 
-        VkDescriptorBufferInfo imageBufferInfo = {};
-        imageBufferInfo.buffer = imageBuffer;
-        imageBufferInfo.offset = 0;
-        imageBufferInfo.range = imageBufferSize;
+    if (renderCount > 1) {
+        std::vector<double> repeated(renderMs.begin() + 1, renderMs.end());
+        std::sort(repeated.begin(), repeated.end());
+        double mean = 0.0;
+        for (double ms : repeated) {
+            mean += ms;
+        }
+        mean /= repeated.size();
+        std::cout << "First render " << renderMs[0] << " ms, repeated renders: mean " << mean << " ms, median "
+                  << repeated[repeated.size() / 2] << " ms, min " << repeated.front() << " ms" << std::endl;
+    }
 
-        std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
+    context.getBufferPool().printStats();
 
-        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrites[0].dstSet = descriptorSet;
-        descriptorWrites[0].dstBinding = 0;
-        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        descriptorWrites[0].descriptorCount = 1;
-        descriptorWrites[0].pBufferInfo = &gaussianBufferInfo;
+    const Camera& lastCamera = cameras[(renderCount - 1) % cameras.size()];
+    const RenderRegion fullImage = {0, 0, lastCamera.width, lastCamera.height};
+    std::vector<uint8_t> pixelData = convertToRGBA8(image.data(), fullImage);
+    stbi_write_png("output.png", fullImage.width, fullImage.height, 4, pixelData.data(), fullImage.width * 4);
+    std::cout << "Image saved as output.png" << std::endl;
+}
 
-        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrites[1].dstSet = descriptorSet;
-        descriptorWrites[1].dstBinding = 1;
-        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        descriptorWrites[1].descriptorCount = 1;
-        descriptorWrites[1].pBufferInfo = &imageBufferInfo;
+void checkCPUMemoryAlignment() {
+    std::cout << "Offsets in C++ Gaussian struct:\n";
+    std::cout << "x: " << offsetof(Gaussian, x) << "\n";
+    std::cout << "y: " << offsetof(Gaussian, y) << "\n";
+    std::cout << "r: " << offsetof(Gaussian, r) << "\n";
+    std::cout << "g: " << offsetof(Gaussian, g) << "\n";
+    std::cout << "b: " << offsetof(Gaussian, b) << "\n";
+    std::cout << "ic11: " << offsetof(Gaussian, ic11) << "\n";
+    std::cout << "opacity: " << offsetof(Gaussian, opacity) << "\n";
+    std::cout << "min_x: " << offsetof(Gaussian, min_x) << "\n";
 
-        vkUpdateDescriptorSets(vulkan.device, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    std::cout << "Total size of struct: " << sizeof(Gaussian) << " bytes\n";
+}
+
+int main(int argc, char** argv) {
+    try {
+        auto startupStart = Clock::now();
+        checkCPUMemoryAlignment();
+
+        // Startup is a small dependency graph: the scene files are decoded and the SPIR-V
+        // read on worker threads while the instance and device are created; the splatting
+        // pipeline is compiled on another one once its layout exists (see below).
+        const SceneOptions sceneOptions = parseSceneOptions(argc, argv);
+        StartupTiming startup;
+        std::vector<std::future<DecodedScene>> sceneDecodes = startSceneDecoding(sceneOptions);
+
+        auto deviceStart = Clock::now();
+        VulkanSetup vulkan(startupShaderFiles(argc, argv));
+        startup.deviceMs = elapsedMs(deviceStart, Clock::now());
+
+        // Data setup. With --scene the 3D Gaussians are preprocessed on the GPU for the
+        // first camera of --camera (or the first --views cameras, or every camera in turn
+        // with --trajectory), which also sets the image size.
+        const bool gpuPreprocess = !sceneOptions.sceneFiles.empty();
+        const uint32_t viewCount = parseViewCount(argc, argv);
+        const bool trajectory = parseTrajectory(argc, argv);
+        if (trajectory && !gpuPreprocess) {
+            throw std::runtime_error("--trajectory needs --scene");
+        }
+
+        std::vector<Camera> cameras;
+        int width = 5068;
+        int height = 3326;
+        if (gpuPreprocess) {
+            cameras = loadCameras(sceneOptions.cameraFile);
+            width = cameras[0].width;
+            height = cameras[0].height;
+            if (viewCount > cameras.size()) {
+                throw std::runtime_error("--views " + std::to_string(viewCount) + " needs as many cameras, " +
+                                         sceneOptions.cameraFile + " has " + std::to_string(cameras.size()));
+            }
+            // The image buffers are sized once: for the largest camera of a trajectory, whose
+            // frames each render at their own size, or for the first camera of --views
+            if (trajectory) {
+                for (const Camera& camera : cameras) {
+                    width = std::max(width, camera.width);
+                    height = std::max(height, camera.height);
+                }
+            } else {
+                for (size_t view = 1; view < viewCount; ++view) {
+                    if (cameras[view].width != width || cameras[view].height != height) {
+                        throw std::runtime_error("--views needs cameras with the same image size");
+                    }
+                }
+            }
+            if (trajectory) {
+                std::cout << "Trajectory: " << cameras.size() << " cameras, " << viewCount << " per frame" << std::endl;
+            } else if (cameras.size() > viewCount) {
+                std::cout << "Rendering the first " << viewCount << " of " << cameras.size() << " cameras" << std::endl;
+            }
+        }
+
+        const RenderRegion region = parseRenderRegion(argc, argv, width, height);
+        // --trajectory: each camera renders the part of the region inside its own image
+        std::vector<RenderRegion> cameraRegions;
+        if (trajectory) {
+            for (const Camera& camera : cameras) {
+                cameraRegions.push_back(clampRegion(region, camera.width, camera.height));
+            }
+        }
+        const BatchOptions options = parseBatchOptions(argc, argv,
+            trajectory ? static_cast<int>((cameras.size() + viewCount - 1) / viewCount) : 1);
+        const RenderMode mode = parseRenderMode(argc, argv);
+        const bool colorMode = mode == RenderMode::Color;
+        KernelType kernel = parseKernelType(argc, argv);
+        const VkSubgroupFeatureFlags subgroupOperations = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_VOTE_BIT |
+                                                          VK_SUBGROUP_FEATURE_BALLOT_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT;
+        if (kernel == KernelType::Subgroup && !vulkan.supportsSubgroupOperations(subgroupOperations)) {
+            std::cout << "Subgroup vote/ballot/arithmetic operations are not supported in compute shaders, "
+                      << "falling back to --kernel tiled" << std::endl;
+            kernel = KernelType::Tiled;
+        }
+        // Both tiled kernels share the binning, the buffers and the dispatch
+        const bool tiled = kernel != KernelType::Naive;
+        if (tiled && !colorMode) {
+            throw std::runtime_error("--kernel tiled and subgroup only support --mode color");
+        }
+        const bool autotune = parseAutotune(argc, argv);
+        const bool comparePrecision = parseComparePrecision(argc, argv);
+        Precision precision = parsePrecision(argc, argv);
+        if ((precision != Precision::Full || comparePrecision) && (tiled || !colorMode)) {
+            // The tiled kernels and the depth modes have no half layout: the tiled ones read
+            // the fp32 records the GPU preprocessing writes in place
+            throw std::runtime_error("--precision and --compare-precision need the naive kernel in color mode "
+                                     "(the tiled kernels and the depth/alpha modes only read fp32 records)!");
+        }
+        if (precision == Precision::HalfMath && !vulkan.supportsHalfArithmetic()) {
+            std::cout << "shaderFloat16 or 16-bit storage buffers are not supported, falling back to --precision half" << std::endl;
+            precision = Precision::Half;
+        }
+        uint32_t persistentGroups = parsePersistentGroups(argc, argv);
+        const bool persistent = persistentGroups > 0;
+        if (persistent && !tiled) {
+            throw std::runtime_error("--persistent needs --kernel tiled or subgroup");
+        }
+
+        // The tiled kernel on a GPU-preprocessed scene also bins on the GPU, so the
+        // preprocessed Gaussians never leave the device
+        const bool gpuBinning = gpuPreprocess && tiled;
+        if (viewCount > 1 && !gpuBinning) {
+            throw std::runtime_error("--views needs --scene with --kernel tiled or subgroup");
+        }
+        const VkDeviceSize streamChunkSize = parseStreamChunkSize(argc, argv);
+        const bool streaming = streamChunkSize > 0;
+        if (streaming && !gpuBinning) {
+            throw std::runtime_error("--stream needs --scene with --kernel tiled or subgroup");
+        }
+        if (viewCount > GpuPreprocessor::MAX_VIEWS) {
+            throw std::runtime_error("--views is limited to " + std::to_string(GpuPreprocessor::MAX_VIEWS));
+        }
+        if (trajectory && !gpuBinning) {
+            throw std::runtime_error("--trajectory needs --scene with --kernel tiled or subgroup");
+        }
+        // Every frame slot in flight keeps its own cameras in the uniform array
+        if (trajectory && static_cast<uint64_t>(options.slotCount) * viewCount > GpuPreprocessor::MAX_VIEWS) {
+            throw std::runtime_error("--trajectory is limited to " + std::to_string(GpuPreprocessor::MAX_VIEWS) +
+                                     " views over all --slots");
+        }
+        const std::string tileStatsPrefix = parseTileStatsPrefix(argc, argv);
+        const bool tileStats = !tileStatsPrefix.empty();
+        if (tileStats && !tiled) {
+            throw std::runtime_error("--tile-stats needs --kernel tiled or subgroup");
+        }
 
-        std::cout << "Descriptor sets updated." << std::endl;
+        // --context-renders: the reusable RenderContext instead of the batch below
+        const uint32_t contextRenders = parseContextRenders(argc, argv);
+        if (contextRenders > 0) {
+            if (!gpuBinning || viewCount > 1 || streaming || persistent || tileStats) {
+                throw std::runtime_error("--context-renders needs --scene with --kernel tiled or subgroup, "
+                                         "without --views, --stream, --persistent or --tile-stats");
+            }
+            runContextRenders(vulkan, sceneOptions, sceneDecodes, cameras, kernel == KernelType::Subgroup, contextRenders);
+            return EXIT_SUCCESS;
+        }
 
-        // Pipeline layout
-        VkPushConstantRange pushConstantRange = {};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(PushConstants);
+        std::cout << "Render region: " << region.width << "x" << region.height
+                  << " at (" << region.x << ", " << region.y << ")" << std::endl;
+
+        // Splatting shader and its layouts come first, so its pipeline compiles during the scene setup
+        const std::string shaderFile = splatShaderFile(kernel, colorMode, precision);
+        const uint32_t tileCount = ((region.width + 15) / 16) * ((region.height + 15) / 16);
+
+        // Output image buffers, tightly packed to the render region. One per frame slot in
+        // flight so frame N+1 can be dispatched while frame N is read back and encoded. They
+        // come from the batch's pool for every frame and return to it once the frame's copy
+        // timeline value has been reached (see retireSlot), so a steady state reuses the same
+        // ones. With --views the views share the image buffer and each one is copied into its
+        // layer of the readback buffer.
+        const int outputChannels = colorMode ? 4 : 1; // RGBA, or a single depth/alpha value
+        auto regionImageSize = [&](const RenderRegion& imageRegion) {
+            return static_cast<VkDeviceSize>(imageRegion.width) * imageRegion.height * sizeof(float) * outputChannels;
+        };
+        const VkDeviceSize imageBufferSize = regionImageSize(region);
+
+        // Layouts, frame slots, timelines and the buffer pool of the batch, all destroyed with it.
+        // Declared before the preprocessor and the binner, which hold buffers from its pool.
+        BatchContext::SlotBufferSizes slotBufferSizes = {};
+        slotBufferSizes.image = imageBufferSize;
+        slotBufferSizes.readback = imageBufferSize * viewCount;
+        slotBufferSizes.tileStats = tileStats ? sizeof(TileStats) * tileCount : sizeof(TileStats);
+        slotBufferSizes.hostVisibleTileStats = tileStats;
+        BatchContext batch(vulkan, static_cast<uint32_t>(options.slotCount), tiled, sizeof(PushConstants), slotBufferSizes);
+        const VkPipelineLayout pipelineLayout = batch.getPipelineLayout();
+        TransientBufferPool& bufferPool = batch.getBufferPool();
+
+        // Workgroup shape and batch size, tuned per device by --autotune
+        std::string kernelName = colorMode ? "naive" : "depth";
+        if (precision == Precision::Half) {
+            kernelName = "naive-half";
+        } else if (precision == Precision::HalfMath) {
+            kernelName = "naive-half-math";
+        } else if (tiled) {
+            kernelName = kernel == KernelType::Subgroup ? "subgroup" : "tiled";
+        }
+        const std::string kernelConfigFile = kernelConfigPath(vulkan.getDeviceUUID());
+        KernelConfig kernelConfig;
+        if (loadKernelConfig(kernelConfigFile, kernelName, kernelConfig)) {
+            std::cout << "Kernel config (" << kernelName << ", from " << kernelConfigFile << "): "
+                      << kernelConfig.describe() << std::endl;
+        } else if (!autotune) {
+            std::cout << "Kernel config (" << kernelName << ", default): " << kernelConfig.describe()
+                      << ". Run with --autotune to tune it for this device." << std::endl;
+        }
 
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-        pipelineLayoutInfo.pushConstantRangeCount = 1;
-        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        kernelConfig.persistentThreads = persistent ? 1 : 0;
+        if (persistentGroups == AUTO_PERSISTENT_GROUPS) {
+            persistentGroups = estimatePersistentGroups(vulkan, kernelConfig);
+            const VulkanSetup::ComputeUnits units = vulkan.getComputeUnits();
+            std::cout << "Persistent workgroups " << (units.count > 0 ? "estimated for " + std::to_string(units.count) +
+                                                      " compute units" : "defaulted, no compute unit query")
+                      << " (--persistent-groups overrides)" << std::endl;
+        }
+        if (persistent) {
+            std::cout << "Persistent threads: " << persistentGroups << " workgroups, tiles heaviest first" << std::endl;
+        }
+        kernelConfig.tileStats = tileStats ? 1 : 0;
+        if (tileStats) {
+            std::cout << "Tile statistics: " << tileCount << " tiles, heatmaps to " << tileStatsPrefix << "_*.png" << std::endl;
+        }
 
-        VkPipelineLayout pipelineLayout;
-        if (vkCreatePipelineLayout(vulkan.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create pipeline layout!");
+        // Compute pipeline creation, through the on-disk pipeline cache. It only needs the layout
+        // and the configuration, so it compiles on a worker while the scene is uploaded,
+        // preprocessed and binned.
+        std::future<VkPipeline> splatPipeline = std::async(std::launch::async,
+            [&vulkan, &startup, shaderFile, pipelineLayout, kernelConfig]() {
+                auto start = Clock::now();
+                VkSpecializationInfo specializationInfo = kernelSpecializationInfo(kernelConfig);
+                VkPipeline pipeline = vulkan.createComputePipeline(shaderFile, pipelineLayout, &specializationInfo);
+                startup.splatPipelineMs = elapsedMs(start, Clock::now());
+                return pipeline;
+            });
+
+        std::vector<float> depths;
+        std::vector<Gaussian> gaussians;
+        std::unique_ptr<StreamingUploader> uploader;
+        std::unique_ptr<SceneRegistry> sceneRegistry;
+        std::unique_ptr<GpuPreprocessor> preprocessor;
+        auto streamStart = Clock::now();
+        if (gpuPreprocess) {
+            // Every --scene stays resident; frames pick theirs by index (see the frame loop).
+            // With --stream the uploads only start here and continue during the first frames.
+            if (streaming) {
+                uploader = std::make_unique<StreamingUploader>(vulkan, streamChunkSize);
+                std::cout << "Streaming scene upload in " << (streamChunkSize >> 20) << " MiB chunks" << std::endl;
+            }
+            sceneRegistry = std::make_unique<SceneRegistry>(vulkan, uploader.get());
+            for (auto& decode : sceneDecodes) {
+                std::vector<SceneGaussian> scene = takeDecodedScene(decode, startup).scene;
+                const size_t sceneSize = scene.size();
+                if (streaming) {
+                    auto orderStart = Clock::now();
+                    orderForStreaming(scene, cameras[0]);
+                    std::cout << "Ordered for streaming (nearest first) in " << elapsedMs(orderStart, Clock::now()) << " ms" << std::endl;
+                }
+                uint32_t sceneIndex = sceneRegistry->addScene(std::move(scene));
+                std::cout << "Scene " << sceneIndex << " loaded: " << sceneSize << " Gaussians" << std::endl;
+            }
+            streamStart = Clock::now();
+            sceneRegistry->pump();
+            if (sceneRegistry->getSceneCount() > 1 && !gpuBinning) {
+                std::cout << "Rendering the first of " << sceneRegistry->getSceneCount()
+                          << " scenes (cycling scenes needs GPU binning)" << std::endl;
+            }
+
+            auto preprocessStart = Clock::now();
+            preprocessor = std::make_unique<GpuPreprocessor>(vulkan, *sceneRegistry, 0, &bufferPool);
+            auto runStart = Clock::now();
+            preprocessor->run(cameras[0]);
+            auto runEnd = Clock::now();
+
+            std::cout << "GPU preprocessing: setup " << elapsedMs(preprocessStart, runStart)
+                      << " ms, pass " << elapsedMs(runStart, runEnd) << " ms" << std::endl;
+
+            // All views' cameras live in the uniform array; frames pick them by index.
+            // A trajectory writes each frame's cameras when its slot is recorded.
+            if (viewCount > 1 && !trajectory) {
+                preprocessor->setCameras(std::vector<Camera>(cameras.begin(), cameras.begin() + viewCount));
+            }
+
+            // The naive and depth kernels need one global depth order, sorted on the host
+            if (!gpuBinning) {
+                auto readbackStart = Clock::now();
+                gaussians = preprocessor->readVisible(&depths);
+                std::cout << "Visible: " << gaussians.size() << ", readback + sort "
+                          << elapsedMs(readbackStart, Clock::now()) << " ms" << std::endl;
+            }
+        } else {
+            DecodedScene decoded = takeDecodedScene(sceneDecodes[0], startup);
+            gaussians = std::move(decoded.gaussians);
+            depths = std::move(decoded.depths);
+            if (mode != RenderMode::Color && depths.size() != gaussians.size()) {
+                throw std::runtime_error("Depth and alpha modes need the 15th (depth) CSV column in every row!");
+            }
+        }
+        // Gaussian buffer (binding 0). GPU binning reads the preprocessing output in place.
+        VkBuffer gaussianBuffer = VK_NULL_HANDLE;
+        VkDeviceSize gaussianBufferSize = VK_WHOLE_SIZE;
+        if (gpuBinning) {
+            gaussianBuffer = preprocessor->getGaussianBuffer();
+        } else {
+            size_t totalGaussians = gaussians.size();
+            gaussians = cullToRegion(gaussians, region, &depths);
+            std::cout << "Gaussians overlapping region: " << gaussians.size() << " / " << totalGaussians << std::endl;
+            // Storage buffers cannot be empty: an empty region gets one transparent Gaussian
+            // whose bounds lie left of it, so every kernel and the tile binning skip it and
+            // the region renders cleared
+            if (gaussians.empty()) {
+                Gaussian placeholder = {};
+                placeholder.min_x = placeholder.max_x = static_cast<float>(region.x - 2);
+                placeholder.min_y = placeholder.max_y = static_cast<float>(region.y - 2);
+                placeholder.x = placeholder.min_x;
+                placeholder.y = placeholder.min_y;
+                gaussians.push_back(placeholder);
+                depths.push_back(0.0f);
+                std::cout << "No Gaussians overlap the render region, rendering it cleared" << std::endl;
+            }
+
+            if (comparePrecision) {
+                PushConstants comparePc = {width, height, region.x, region.y, region.width, region.height, 0};
+                runPrecisionComparison(vulkan, gaussians, region, comparePc);
+                batch.setPipeline(splatPipeline.get());
+                return EXIT_SUCCESS;
+            }
+
+            for (size_t i = 0; i < 5 && i < gaussians.size(); ++i) {
+                const auto& g = gaussians[i];
+                std::cout << "Gaussian " << i << ": "
+                        << "x=" << g.x << ", y=" << g.y
+                        << ", r=" << g.r << ", g=" << g.g << ", b=" << g.b
+                        << ", ic11=" << g.ic11 << ", ic12=" << g.ic12
+                        << ", ic21=" << g.ic21 << ", ic22=" << g.ic22
+                        << ", opacity=" << g.opacity
+                        << ", min_x=" << g.min_x << ", max_x=" << g.max_x
+                        << ", min_y=" << g.min_y << ", max_y=" << g.max_y
+                        << std::endl;
+            }
+
+            // Depth/alpha modes upload the reduced layout, --precision half the packed one
+            std::vector<DepthGaussian> depthGaussians;
+            std::vector<HalfGaussian> halfGaussians;
+            const void* gaussianData = gaussians.data();
+            gaussianBufferSize = sizeof(Gaussian) * gaussians.size();
+            if (!colorMode) {
+                depthGaussians = toDepthGaussians(gaussians, depths);
+                gaussianData = depthGaussians.data();
+                gaussianBufferSize = sizeof(DepthGaussian) * depthGaussians.size();
+            } else if (precision != Precision::Full) {
+                halfGaussians = toHalfGaussians(gaussians);
+                gaussianData = halfGaussians.data();
+                gaussianBufferSize = sizeof(HalfGaussian) * halfGaussians.size();
+            }
+            std::cout << "Gaussian buffer: " << gaussianBufferSize << " bytes ("
+                      << gaussianBufferSize / gaussians.size() << " bytes per splat)" << std::endl;
+
+            // Device-local Gaussian buffer, uploaded through a staging buffer
+            auto uploadStart = Clock::now();
+            vulkan.createDeviceLocalBuffer(gaussianBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                gaussianData, gaussianBuffer);
+            batch.adoptBuffer(gaussianBuffer);
+
+            std::cout << "Input buffers created and data uploaded in " << elapsedMs(uploadStart, Clock::now()) << " ms." << std::endl;
+
+            // read back and verify uploaded data
+            // (fp32 color layout only; the other modes upload DepthGaussian or HalfGaussian records)
+            std::vector<Gaussian> uploadedData;
+            if (colorMode && precision == Precision::Full) {
+                VkBuffer verifyBuffer;
+                vulkan.createReadbackBuffer(gaussianBufferSize, verifyBuffer);
+                vulkan.copyBuffer(gaussianBuffer, verifyBuffer, gaussianBufferSize);
+
+                vulkan.invalidateBuffer(verifyBuffer);
+                uploadedData.resize(gaussians.size());
+                std::memcpy(uploadedData.data(), vulkan.mapBuffer(verifyBuffer), gaussianBufferSize);
+
+                vulkan.destroyBuffer(verifyBuffer);
+            }
+
+            for (size_t i = 0; i < 5 && i < uploadedData.size(); ++i) {
+                const auto& g = uploadedData[i];
+                std::cout << "Uploaded Gaussian " << i << ": "
+                        << "x=" << g.x << ", y=" << g.y
+                        << ", r=" << g.r << ", g=" << g.g << ", b=" << g.b
+                        << ", ic11=" << g.ic11 << ", ic12=" << g.ic12
+                        << ", ic21=" << g.ic21 << ", ic22=" << g.ic22
+                        << ", opacity=" << g.opacity
+                        << ", min_x=" << g.min_x << ", max_x=" << g.max_x
+                        << ", min_y=" << g.min_y << ", max_y=" << g.max_y
+                        << std::endl;
+            }
         }
 
-        // Compute pipeline creation
-        VkComputePipelineCreateInfo pipelineInfo = {};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-        pipelineInfo.stage.module = computeShaderModule;
-        pipelineInfo.stage.pName = "main";
-        pipelineInfo.layout = pipelineLayout;
+        // Per-tile Gaussian lists for the tiled kernel, shared by all frame slots
+        VkBuffer tileGaussianBuffer = VK_NULL_HANDLE;
+        VkBuffer tileRangeBuffer = VK_NULL_HANDLE;
+        VkBuffer activeTileBuffer = VK_NULL_HANDLE;
+        VkDeviceSize tileGaussianBufferSize = VK_WHOLE_SIZE;
+        VkDeviceSize tileRangeBufferSize = VK_WHOLE_SIZE;
+        VkDeviceSize activeTileBufferSize = VK_WHOLE_SIZE;
+        uint32_t activeTileCount = 0;
+        std::unique_ptr<GpuTileBinner> tileBinner;
+        if (gpuBinning) {
+            uint32_t maxPairs = sceneOptions.maxTilePairs;
+            if (maxPairs == 0) {
+                maxPairs = preprocessor->getGaussianCount() * 8;
+            }
+
+            VkRect2D binRegion = {};
+            binRegion.offset = {region.x, region.y};
+            binRegion.extent = {static_cast<uint32_t>(region.width), static_cast<uint32_t>(region.height)};
+            tileBinner = std::make_unique<GpuTileBinner>(vulkan, preprocessor->getGaussianBuffer(), preprocessor->getDepthBuffer(),
+                                                         preprocessor->getGaussianCount(), binRegion, maxPairs, persistent,
+                                                         persistentGroups, &bufferPool);
+            tileGaussianBuffer = tileBinner->getTileGaussianBuffer();
+            tileRangeBuffer = tileBinner->getTileRangeBuffer();
+            activeTileBuffer = tileBinner->getActiveTileBuffer();
+            std::cout << "GPU tile binning: capacity " << maxPairs << " tile/Gaussian pairs" << std::endl;
+        } else if (tiled) {
+            auto binStart = Clock::now();
+            TileBins bins = binToTiles(gaussians, region);
+            std::cout << "Tile binning: " << bins.tilesX << "x" << bins.tilesY << " tiles, "
+                      << bins.gaussianIndices.size() << " tile/Gaussian pairs ("
+                      << static_cast<double>(bins.gaussianIndices.size()) / (bins.tilesX * bins.tilesY)
+                      << " per tile, " << bins.activeTiles.size() << " tiles non-empty) in "
+                      << elapsedMs(binStart, Clock::now()) << " ms" << std::endl;
+            activeTileCount = static_cast<uint32_t>(bins.activeTiles.size());
+
+            // Persistent workgroups take the tiles in list order, so start with the heaviest
+            if (persistent) {
+                std::stable_sort(bins.activeTiles.begin(), bins.activeTiles.end(), [&](uint32_t a, uint32_t b) {
+                    return bins.ranges[a * 2 + 1] - bins.ranges[a * 2] > bins.ranges[b * 2 + 1] - bins.ranges[b * 2];
+                });
+            }
+
+            // Storage buffers cannot be empty, even when no Gaussian touches any tile
+            if (bins.gaussianIndices.empty()) {
+                bins.gaussianIndices.push_back(0);
+                bins.activeTiles.push_back(0);
+            }
+
+            tileGaussianBufferSize = sizeof(uint32_t) * bins.gaussianIndices.size();
+            tileRangeBufferSize = sizeof(uint32_t) * bins.ranges.size();
+            activeTileBufferSize = sizeof(uint32_t) * bins.activeTiles.size();
+            vulkan.createDeviceLocalBuffer(tileGaussianBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                bins.gaussianIndices.data(), tileGaussianBuffer);
+            vulkan.createDeviceLocalBuffer(tileRangeBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                bins.ranges.data(), tileRangeBuffer);
+            vulkan.createDeviceLocalBuffer(activeTileBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                bins.activeTiles.data(), activeTileBuffer);
+            batch.adoptBuffer(tileGaussianBuffer);
+            batch.adoptBuffer(tileRangeBuffer);
+            batch.adoptBuffer(activeTileBuffer);
+        }
 
-        VkPipeline computePipeline;
-        if (vkCreateComputePipelines(vulkan.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create compute pipeline!");
+        // The Gaussian buffer and the tile lists are shared by the slots, the slots' own
+        // buffers are bound when the pool hands them out (BatchContext::acquireSlotBuffers)
+        BatchContext::SharedBuffers sharedBuffers = {};
+        sharedBuffers.gaussians = {gaussianBuffer, 0, gaussianBufferSize};
+        sharedBuffers.tileGaussians = {tileGaussianBuffer, 0, tileGaussianBufferSize};
+        sharedBuffers.tileRanges = {tileRangeBuffer, 0, tileRangeBufferSize};
+        sharedBuffers.activeTiles = {activeTileBuffer, 0, activeTileBufferSize};
+        std::vector<FrameSlot> slots(options.slotCount);
+        for (auto& slot : slots) {
+            batch.initSlot(slot, sharedBuffers);
+            slot.viewRegions.assign(viewCount, region);
         }
+        const uint32_t slotCount = static_cast<uint32_t>(slots.size());
+
+        std::cout << slots.size() << " frame slots created successfully." << std::endl;
+        vulkan.printMemoryStats();
+
+        auto pipelineWaitStart = Clock::now();
+        VkPipeline computePipeline = splatPipeline.get();
+        batch.setPipeline(computePipeline);
+        startup.splatPipelineWaitMs = elapsedMs(pipelineWaitStart, Clock::now());
 
         std::cout << "Compute pipeline created successfully." << std::endl;
+        vulkan.pipelineCache.printStats();
 
         if (vulkan.commandPool == VK_NULL_HANDLE) {
             throw std::runtime_error("Command pool is not initialized!");
@@ -295,63 +1526,548 @@ int main() {
         std::cout << "Command pool and logical device verified." << std::endl;
 
 
-        // Allocate command buffer
-        VkCommandBufferAllocateInfo allocInfoCmd = {};
-        allocInfoCmd.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfoCmd.commandPool = vulkan.commandPool;
-        allocInfoCmd.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfoCmd.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer;
-        if (vkAllocateCommandBuffers(vulkan.device, &allocInfoCmd, &commandBuffer) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to allocate command buffer!");
+        // Frame N's compute submission sets the splat timeline to N + 1 and its readback
+        // copy sets the copy timeline to N + 1 (one timeline per queue, so each only ever
+        // counts up). The copy waits for the splat on the device and the host waits for the
+        // copy, so splatting frame N runs while frame N - 1 is copied and frame N - 2 is
+        // encoded. With --views the copies stay in the compute command buffer (the views
+        // share one image buffer) and the compute submission sets both timelines.
+        const VkSemaphore splatTimeline = batch.getSplatTimeline();
+        const VkSemaphore copyTimeline = batch.getCopyTimeline();
+        auto frameValue = [](int frame) { return static_cast<uint64_t>(frame) + 1; };
+        const bool separateCopy = viewCount == 1;
+        if (separateCopy) {
+            std::cout << "Readback copies on the " << (vulkan.hasDedicatedTransferQueue() ? "dedicated transfer" : "compute")
+                      << " queue" << std::endl;
         }
 
-        // Record commands
-        VkCommandBufferBeginInfo beginInfo = {};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-
-        // Dispatch the compute shader 
-        PushConstants pc = {width, height};
-        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
-
-        vkCmdDispatch(commandBuffer, (width + 15) / 16, (height + 15) / 16, 1);
+        // --trace: GPU timestamps around each frame's compute and copy submissions
+        const std::string traceFile = parseTraceFile(argc, argv);
+        const bool traceCompute = !traceFile.empty() && vulkan.getTimestampValidBits(vulkan.computeQueueFamily) > 0;
+        const bool traceTransfer = traceCompute && separateCopy && vulkan.getTimestampValidBits(vulkan.transferQueueFamily) > 0;
+        if (!traceFile.empty() && !traceCompute) {
+            std::cout << "The compute queue has no timestamps, --trace is ignored" << std::endl;
+        }
+        VkQueryPool traceQueries = VK_NULL_HANDLE;
+        if (traceCompute) {
+            VkQueryPoolCreateInfo queryInfo = {};
+            queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryInfo.queryCount = 4 * options.frameCount; // compute begin/end, copy begin/end
+            if (vkCreateQueryPool(vulkan.device, &queryInfo, nullptr, &traceQueries) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create trace query pool!");
+            }
+        }
 
-        vkEndCommandBuffer(commandBuffer);
+        // --profile: per-pass GPU time and compute invocations of every frame
+        const std::string profileFile = parseProfileFile(argc, argv);
+        std::unique_ptr<GpuProfiler> profiler;
+        if (!profileFile.empty()) {
+            // preprocess, binning, sort, tile ranges, splat and readback per view
+            profiler = std::make_unique<GpuProfiler>(vulkan, options.frameCount, 6 * viewCount);
+            std::cout << "Profiling GPU passes" << (profiler->hasPipelineStatistics() ? " with compute invocation counts" : "")
+                      << std::endl;
+        }
 
-        std::cout << "Commands recorded successfully." << std::endl;
+        // --tile-stats: the counters of the last frame, copied out when it is retired
+        std::vector<TileStats> lastTileStats;
+        RenderRegion lastTileStatsRegion = region;
+
+        PushConstants pc = {width, height, region.x, region.y, region.width, region.height, mode == RenderMode::Depth ? 1 : 0};
+        std::vector<FrameTiming> timings(options.frameCount);
+
+        // Waits for the frame in flight in a slot, then reads it back and encodes it
+        auto retireSlot = [&](FrameSlot& slot) {
+            FrameTiming& timing = timings[slot.frameIndex];
+
+            auto waitStart = Clock::now();
+            vulkan.waitTimelineSemaphore(copyTimeline, frameValue(slot.frameIndex));
+            auto readbackStart = Clock::now();
+
+            vulkan.invalidateBuffer(slot.readbackBuffer);
+            const char* mappedMemory = static_cast<const char*>(vulkan.mapBuffer(slot.readbackBuffer));
+            timing.waitMs = elapsedMs(waitStart, readbackStart);
+            timing.readbackMs = 0.0;
+            timing.encodeMs = 0.0;
+
+            // One image per view, each from its layer of the readback buffer
+            for (uint32_t view = 0; view < viewCount; ++view) {
+                auto layerStart = Clock::now();
+                const RenderRegion& viewRegion = slot.viewRegions[view];
+                const char* layer = mappedMemory + view * imageBufferSize;
+                std::string filename = outputFilename(slot.frameIndex, options.frameCount);
+                if (viewCount > 1) {
+                    filename += "_view" + std::to_string(view);
+                }
+                std::vector<uint8_t> pixelData;
+                if (colorMode) {
+                    pixelData = convertToRGBA8(reinterpret_cast<const float*>(layer), viewRegion);
+                } else {
+                    // Keep the raw single-channel floats next to the 8-bit preview
+                    std::ofstream raw(filename + ".bin", std::ios::binary);
+                    raw.write(layer, regionImageSize(viewRegion));
+                    pixelData = convertToGray8(reinterpret_cast<const float*>(layer), viewRegion, mode);
+                }
+                auto encodeStart = Clock::now();
+
+                filename += ".png";
+                stbi_write_png(filename.c_str(), viewRegion.width, viewRegion.height, outputChannels, pixelData.data(),
+                               viewRegion.width * outputChannels);
+
+                timing.readbackMs += elapsedMs(layerStart, encodeStart);
+                timing.encodeMs += elapsedMs(encodeStart, Clock::now());
+                std::cout << "Frame " << slot.frameIndex << " -> " << filename << std::endl;
+            }
+
+            std::cout << "Frame " << slot.frameIndex << ": wait " << timing.waitMs << " ms, readback " << timing.readbackMs
+                      << " ms, encode " << timing.encodeMs << " ms" << std::endl;
+
+            if (tileStats && slot.frameIndex == options.frameCount - 1) {
+                vulkan.invalidateBuffer(slot.tileStatsBuffer);
+                const TileStats* mappedStats = static_cast<const TileStats*>(vulkan.mapBuffer(slot.tileStatsBuffer));
+                lastTileStats.assign(mappedStats, mappedStats + tileCount);
+                lastTileStatsRegion = slot.viewRegions.back();
+            }
+
+            if (profiler) {
+                std::cout << "Frame " << slot.frameIndex << " GPU:";
+                const char* separator = " ";
+                for (const GpuProfiler::PassTiming& pass : profiler->getFrameTimings(slot.frameIndex)) {
+                    std::cout << separator << pass.name << " " << pass.gpuMs << " ms";
+                    if (pass.invocations > 0) {
+                        std::cout << " (" << pass.invocations << " invocations)";
+                    }
+                    separator = ", ";
+                }
+                std::cout << std::endl;
+            }
+
+            // The copy timeline has passed the frame, so its buffers can serve a later one
+            bufferPool.recycle(frameValue(slot.frameIndex));
+            slot.frameIndex = -1;
+        };
+
+        // Records the splatting pass of a frame into the slot's command buffer, timed by
+        // `frameProfiler` (if given) as the binning passes and "splat"
+        auto recordSplat = [&](const FrameSlot& slot, VkPipeline pipeline, const KernelConfig& config, GpuProfiler* frameProfiler) {
+            // Tile lists and the splatting dispatch size, built on the device
+            if (gpuBinning) {
+                tileBinner->record(slot.commandBuffer, frameProfiler);
+            }
+
+            if (frameProfiler) {
+                frameProfiler->beginPass(slot.commandBuffer, "splat");
+            }
+
+            // The tiled kernel only launches non-empty tiles, the rest of the image stays cleared
+            // (the pooled buffers may be larger than the image and the statistics)
+            if (tiled) {
+                vkCmdFillBuffer(slot.commandBuffer, slot.imageBuffer, 0, imageBufferSize, 0);
+                if (config.tileStats) {
+                    vkCmdFillBuffer(slot.commandBuffer, slot.tileStatsBuffer, 0, sizeof(TileStats) * tileCount, 0);
+                }
+
+                // Reset the work queue: all active tiles, none handed out yet
+                if (gpuBinning && persistent) {
+                    computeToTransferBarrier(slot.commandBuffer);
+                    VkBufferCopy countRegion = {};
+                    countRegion.srcOffset = tileBinner->getActiveTileCountOffset();
+                    countRegion.size = sizeof(uint32_t);
+                    vkCmdCopyBuffer(slot.commandBuffer, tileBinner->getStateBuffer(), slot.tileQueueBuffer, 1, &countRegion);
+                    vkCmdFillBuffer(slot.commandBuffer, slot.tileQueueBuffer, sizeof(uint32_t), sizeof(uint32_t), 0);
+                } else if (persistent) {
+                    const uint32_t queue[2] = {activeTileCount, 0};
+                    vkCmdUpdateBuffer(slot.commandBuffer, slot.tileQueueBuffer, 0, sizeof(queue), queue);
+                }
+                transferToComputeBarrier(slot.commandBuffer);
+            }
+
+            vkCmdBindPipeline(slot.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+            vkCmdBindDescriptorSets(slot.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &slot.descriptorSet, 0, nullptr);
+
+            // Dispatch the compute shader 
+            vkCmdPushConstants(slot.commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+
+            // Only the workgroups covering the render region are launched. For the tiled
+            // kernel each workgroup is one non-empty tile; with GPU binning their number
+            // is only known on the device. Persistent workgroups loop over the queue instead.
+            // With GPU binning the persistent launch is clamped to the active tiles on the device.
+            if (persistent && gpuBinning) {
+                vkCmdDispatchIndirect(slot.commandBuffer, tileBinner->getDispatchBuffer(), tileBinner->getPersistentDispatchOffset());
+            } else if (persistent) {
+                vkCmdDispatch(slot.commandBuffer, std::min(persistentGroups, activeTileCount), 1, 1);
+            } else if (gpuBinning) {
+                vkCmdDispatchIndirect(slot.commandBuffer, tileBinner->getDispatchBuffer(), tileBinner->getSplatDispatchOffset());
+            } else if (tiled) {
+                vkCmdDispatch(slot.commandBuffer, activeTileCount, 1, 1);
+            } else {
+                vkCmdDispatch(slot.commandBuffer, (region.width + config.spanX() - 1) / config.spanX(),
+                              (region.height + config.spanY() - 1) / config.spanY(), 1);
+            }
+
+            if (frameProfiler) {
+                frameProfiler->endPass(slot.commandBuffer);
+            }
+        };
+
+        printStartupReport(startup, vulkan.getStartupTimes(), elapsedMs(startupStart, Clock::now()));
+
+        // --autotune: time every candidate configuration on slot 0 (best of a few runs after a
+        // warmup), keep the fastest for this batch and save it for later runs on this device
+        if (autotune) {
+            // Timeline value 0 comes before every frame's, the runs are waited on by the fence
+            FrameSlot& slot = slots[0];
+            batch.acquireSlotBuffers(slot, 0);
+            const int warmupRuns = 1;
+            const int timedRuns = 5;
+
+            KernelConfig bestConfig = kernelConfig;
+            VkPipeline bestPipeline = VK_NULL_HANDLE;
+            double bestMs = 0.0;
+
+            std::cout << "Autotuning the " << kernelName << " kernel..." << std::endl;
+            for (KernelConfig candidate : kernelConfigCandidates(kernelName, vulkan.getDeviceLimits())) {
+                candidate.persistentThreads = kernelConfig.persistentThreads;
+                candidate.tileStats = kernelConfig.tileStats;
+                VkSpecializationInfo candidateInfo = kernelSpecializationInfo(candidate);
+                VkPipeline pipeline = vulkan.createComputePipeline(shaderFile, pipelineLayout, &candidateInfo);
+
+                double candidateMs = 0.0;
+                for (int run = 0; run < warmupRuns + timedRuns; ++run) {
+                    vkResetCommandBuffer(slot.commandBuffer, 0);
+                    VkCommandBufferBeginInfo beginInfo = {};
+                    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+                    recordSplat(slot, pipeline, candidate, nullptr);
+                    vkEndCommandBuffer(slot.commandBuffer);
+
+                    VkSubmitInfo submitInfo = {};
+                    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                    submitInfo.commandBufferCount = 1;
+                    submitInfo.pCommandBuffers = &slot.commandBuffer;
+
+                    auto runStart = Clock::now();
+                    if (vkQueueSubmit(vulkan.computeQueue, 1, &submitInfo, slot.fence) != VK_SUCCESS) {
+                        throw std::runtime_error("Failed to submit autotune command buffer!");
+                    }
+                    vkWaitForFences(vulkan.device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+                    double runMs = elapsedMs(runStart, Clock::now());
+                    vkResetFences(vulkan.device, 1, &slot.fence);
+
+                    if (run == warmupRuns || (run > warmupRuns && runMs < candidateMs)) {
+                        candidateMs = runMs;
+                    }
+                }
+
+                std::cout << "  " << candidate.describe() << ": " << candidateMs << " ms" << std::endl;
+                if (bestPipeline == VK_NULL_HANDLE || candidateMs < bestMs) {
+                    if (bestPipeline != VK_NULL_HANDLE) {
+                        vkDestroyPipeline(vulkan.device, bestPipeline, nullptr);
+                    }
+                    bestConfig = candidate;
+                    bestPipeline = pipeline;
+                    bestMs = candidateMs;
+                } else {
+                    vkDestroyPipeline(vulkan.device, pipeline, nullptr);
+                }
+            }
+
+            if (bestPipeline != VK_NULL_HANDLE) {
+                batch.setPipeline(bestPipeline);
+                computePipeline = bestPipeline;
+                kernelConfig = bestConfig;
+                saveKernelConfig(kernelConfigFile, kernelName, kernelConfig);
+                std::cout << "Kernel config (" << kernelName << ", tuned): " << kernelConfig.describe()
+                          << ", saved to " << kernelConfigFile << std::endl;
+            }
+            bufferPool.recycle(0);
+        }
 
-        VkSubmitInfo submitInfo = {};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
+        auto batchStart = Clock::now();
+
+        for (int frame = 0; frame < options.frameCount; ++frame) {
+            FrameSlot& slot = slots[frame % slotCount];
+
+            // The slot's previous frame must be read back before its buffer is reused
+            if (slot.frameIndex >= 0) {
+                retireSlot(slot);
+            }
+            batch.acquireSlotBuffers(slot, frameValue(frame));
+
+            // --trajectory: this frame's cameras go to the slot's own views, the other
+            // slots' frames may still be reading theirs
+            const uint32_t firstView = trajectory ? static_cast<uint32_t>(frame % slotCount) * viewCount : 0;
+            if (trajectory) {
+                std::vector<Camera> frameCameras;
+                for (uint32_t view = 0; view < viewCount; ++view) {
+                    frameCameras.push_back(cameras[(static_cast<size_t>(frame) * viewCount + view) % cameras.size()]);
+                }
+                preprocessor->setCameras(frameCameras, firstView);
+            }
+
+            auto recordStart = Clock::now();
+
+            // More of the scene may have landed since the last frame; this frame renders
+            // the resident Gaussians and the rest are culled by the preprocessing pass
+            if (streaming) {
+                const bool pending = sceneRegistry->pump();
+                const uint32_t sceneIndex = frame % sceneRegistry->getSceneCount();
+                const uint32_t resident = sceneRegistry->getResidentGaussianCount(sceneIndex);
+                std::cout << "Frame " << frame << ": " << resident << " / " << sceneRegistry->getGaussianCount(sceneIndex)
+                          << " Gaussians resident" << (pending ? "" : " (upload complete)") << std::endl;
+                if (frame == 0) {
+                    std::cout << "Streaming: first frame recorded " << elapsedMs(streamStart, recordStart)
+                              << " ms after the upload started" << std::endl;
+                }
+            }
+
+            vkResetCommandBuffer(slot.commandBuffer, 0);
+
+            // Record commands
+            VkCommandBufferBeginInfo beginInfo = {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+
+            if (traceCompute) {
+                vkCmdResetQueryPool(slot.commandBuffer, traceQueries, 4 * frame, 4);
+                vkCmdWriteTimestamp(slot.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, traceQueries, 4 * frame);
+            }
+            if (profiler) {
+                profiler->beginFrame(slot.commandBuffer, frame);
+            }
+
+            // With several resident scenes, frames cycle through them: re-preprocessing on the
+            // device only takes a different scene index, the tile binning then follows.
+            // With --views every view is preprocessed, binned and splatted in turn, all in
+            // this one command buffer, sharing the scene and the intermediate buffers.
+            // With --trajectory every frame has new cameras, so it is always preprocessed.
+            const bool preprocessPerFrame =
+                gpuBinning && (sceneRegistry->getSceneCount() > 1 || viewCount > 1 || streaming || trajectory);
+            for (uint32_t view = 0; view < viewCount; ++view) {
+                // --trajectory: the view renders at its camera's size. The binner was created for
+                // the largest region, so re-targeting it never replaces buffers still in use.
+                if (trajectory) {
+                    const size_t cameraIndex = (static_cast<size_t>(frame) * viewCount + view) % cameras.size();
+                    const RenderRegion& viewRegion = cameraRegions[cameraIndex];
+                    slot.viewRegions[view] = viewRegion;
+                    pc = {cameras[cameraIndex].width, cameras[cameraIndex].height, viewRegion.x, viewRegion.y,
+                          viewRegion.width, viewRegion.height, pc.outputDepth};
+                    VkRect2D viewBinRegion = {};
+                    viewBinRegion.offset = {viewRegion.x, viewRegion.y};
+                    viewBinRegion.extent = {static_cast<uint32_t>(viewRegion.width), static_cast<uint32_t>(viewRegion.height)};
+                    tileBinner->setRegion(viewBinRegion);
+                }
+
+                if (preprocessPerFrame) {
+                    if (profiler) {
+                        profiler->beginPass(slot.commandBuffer, "preprocess");
+                    }
+                    preprocessor->record(slot.commandBuffer, frame % sceneRegistry->getSceneCount(), firstView + view);
+                    if (profiler) {
+                        profiler->endPass(slot.commandBuffer);
+                    }
+                }
+
+                // The previous view's copy must have read the image before it is cleared again
+                if (view > 0) {
+                    transferBarrier(slot.commandBuffer);
+                }
+
+                recordSplat(slot, computePipeline, kernelConfig, profiler.get());
+
+                // Copy the device-local image into the view's layer of the slot's readback buffer
+                if (!separateCopy) {
+                    if (profiler) {
+                        profiler->beginPass(slot.commandBuffer, "readback");
+                    }
+                    computeToTransferBarrier(slot.commandBuffer);
+                    VkBufferCopy readbackRegion = {};
+                    readbackRegion.dstOffset = view * imageBufferSize;
+                    readbackRegion.size = regionImageSize(slot.viewRegions[view]);
+                    vkCmdCopyBuffer(slot.commandBuffer, slot.imageBuffer, slot.readbackBuffer, 1, &readbackRegion);
+                    if (profiler) {
+                        profiler->endPass(slot.commandBuffer);
+                    }
+                }
+            }
+
+            // Make the copies (and any counters written by the shaders) visible to the host mapping
+            VkMemoryBarrier readbackBarrier = {};
+            readbackBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            readbackBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+            readbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+            vkCmdPipelineBarrier(slot.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &readbackBarrier, 0, nullptr, 0, nullptr);
+
+            if (traceCompute) {
+                vkCmdWriteTimestamp(slot.commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, traceQueries, 4 * frame + 1);
+            }
+
+            vkEndCommandBuffer(slot.commandBuffer);
+
+            const VkSemaphore computeSemaphores[2] = {splatTimeline, copyTimeline};
+            const uint64_t computeSignals[2] = {frameValue(frame), frameValue(frame)};
+            VkTimelineSemaphoreSubmitInfo computeTimelineInfo = {};
+            computeTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            computeTimelineInfo.signalSemaphoreValueCount = separateCopy ? 1 : 2;
+            computeTimelineInfo.pSignalSemaphoreValues = computeSignals;
+
+            VkSubmitInfo submitInfo = {};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.pNext = &computeTimelineInfo;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &slot.commandBuffer;
+            submitInfo.signalSemaphoreCount = separateCopy ? 1 : 2;
+            submitInfo.pSignalSemaphores = computeSemaphores;
+
+            // Streaming: the chunks counted as resident have landed, waiting on them only
+            // makes them visible to the compute queue
+            VkSemaphore uploadTimeline = VK_NULL_HANDLE;
+            uint64_t uploadValue = 0;
+            const VkPipelineStageFlags uploadWaitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            if (streaming) {
+                uploadTimeline = uploader->getTimeline();
+                uploadValue = uploader->getCompletedValue();
+                computeTimelineInfo.waitSemaphoreValueCount = 1;
+                computeTimelineInfo.pWaitSemaphoreValues = &uploadValue;
+                submitInfo.waitSemaphoreCount = 1;
+                submitInfo.pWaitSemaphores = &uploadTimeline;
+                submitInfo.pWaitDstStageMask = &uploadWaitStage;
+            }
+
+            if (vkQueueSubmit(vulkan.computeQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to submit compute command buffer!");
+            }
+
+            // The readback copy waits for the splatting on the device, not on the host
+            if (separateCopy) {
+                vkResetCommandBuffer(slot.transferCommandBuffer, 0);
+                vkBeginCommandBuffer(slot.transferCommandBuffer, &beginInfo);
+                // The copy queries were reset by the compute submission, transfer queues cannot
+                if (traceTransfer) {
+                    vkCmdWriteTimestamp(slot.transferCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, traceQueries, 4 * frame + 2);
+                }
+
+                if (profiler) {
+                    profiler->beginPass(slot.transferCommandBuffer, "readback", true);
+                }
+                VkBufferCopy readbackRegion = {};
+                readbackRegion.size = regionImageSize(slot.viewRegions[0]);
+                vkCmdCopyBuffer(slot.transferCommandBuffer, slot.imageBuffer, slot.readbackBuffer, 1, &readbackRegion);
+                if (profiler) {
+                    profiler->endPass(slot.transferCommandBuffer);
+                }
+
+                VkMemoryBarrier copyBarrier = {};
+                copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                copyBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+                vkCmdPipelineBarrier(slot.transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                                     0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+
+                if (traceTransfer) {
+                    vkCmdWriteTimestamp(slot.transferCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, traceQueries, 4 * frame + 3);
+                }
+                vkEndCommandBuffer(slot.transferCommandBuffer);
+
+                const uint64_t copyWait = frameValue(frame);
+                const uint64_t copySignal = frameValue(frame);
+                const VkPipelineStageFlags copyWaitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+                VkTimelineSemaphoreSubmitInfo copyTimelineInfo = {};
+                copyTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+                copyTimelineInfo.waitSemaphoreValueCount = 1;
+                copyTimelineInfo.pWaitSemaphoreValues = &copyWait;
+                copyTimelineInfo.signalSemaphoreValueCount = 1;
+                copyTimelineInfo.pSignalSemaphoreValues = &copySignal;
+
+                VkSubmitInfo copySubmitInfo = {};
+                copySubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                copySubmitInfo.pNext = &copyTimelineInfo;
+                copySubmitInfo.waitSemaphoreCount = 1;
+                copySubmitInfo.pWaitSemaphores = &splatTimeline;
+                copySubmitInfo.pWaitDstStageMask = &copyWaitStage;
+                copySubmitInfo.commandBufferCount = 1;
+                copySubmitInfo.pCommandBuffers = &slot.transferCommandBuffer;
+                copySubmitInfo.signalSemaphoreCount = 1;
+                copySubmitInfo.pSignalSemaphores = &copyTimeline;
+
+                if (vkQueueSubmit(vulkan.transferQueue, 1, &copySubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to submit readback command buffer!");
+                }
+            }
+
+            slot.frameIndex = frame;
+            timings[frame].submitMs = elapsedMs(recordStart, Clock::now());
+        }
 
-        if (vkQueueSubmit(vulkan.computeQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to submit compute command buffer!");
+        // Drain the frames still in flight, oldest first
+        for (int frame = std::max(0, options.frameCount - static_cast<int>(slotCount)); frame < options.frameCount; ++frame) {
+            FrameSlot& slot = slots[frame % slotCount];
+            if (slot.frameIndex == frame) {
+                retireSlot(slot);
+            }
         }
 
-        vkQueueWaitIdle(vulkan.computeQueue);
+        double batchMs = elapsedMs(batchStart, Clock::now());
         std::cout << "Compute shader executed successfully." << std::endl;
-        
-        void* mappedMemory;
-        vkMapMemory(vulkan.device, imageBufferMemory, 0, imageBufferSize, 0, &mappedMemory);
-        float* imageData = static_cast<float*>(mappedMemory);
+        printTimingSummary(timings, batchMs, slotCount);
+
+        if (traceCompute) {
+            std::vector<uint64_t> ticks(4 * options.frameCount, 0);
+            vkGetQueryPoolResults(vulkan.device, traceQueries, 0, static_cast<uint32_t>(ticks.size()),
+                                  ticks.size() * sizeof(uint64_t), ticks.data(), sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+            const double usPerTick = vulkan.getDeviceLimits().timestampPeriod / 1000.0;
+
+            std::vector<TraceSpan> spans;
+            for (int frame = 0; frame < options.frameCount; ++frame) {
+                const uint64_t* frameTicks = &ticks[4 * frame];
+                spans.push_back({"frame " + std::to_string(frame) + " compute", 0,
+                                 frameTicks[0] * usPerTick, frameTicks[1] * usPerTick});
+                if (traceTransfer) {
+                    spans.push_back({"frame " + std::to_string(frame) + " readback", 1,
+                                     frameTicks[2] * usPerTick, frameTicks[3] * usPerTick});
+                }
+            }
+            writeQueueTrace(traceFile, spans);
+            vkDestroyQueryPool(vulkan.device, traceQueries, nullptr);
+        }
+
+        if (profiler) {
+            const bool json = profileFile.size() >= 5 && profileFile.compare(profileFile.size() - 5, 5, ".json") == 0;
+            if (json) {
+                profiler->writeJson(profileFile);
+            } else {
+                profiler->writeCsv(profileFile);
+            }
+        }
 
-        std::vector<uint8_t> pixelData(width * height * 4); // RGBA output
-        for (size_t i = 0; i < width * height; ++i) {
-            pixelData[i * 4 + 0] = static_cast<uint8_t>(imageData[i * 4 + 0] * 255.0f); // R
-            pixelData[i * 4 + 1] = static_cast<uint8_t>(imageData[i * 4 + 1] * 255.0f); // G
-            pixelData[i * 4 + 2] = static_cast<uint8_t>(imageData[i * 4 + 2] * 255.0f); // B
-            pixelData[i * 4 + 3] = 255; // A
+        // With --views the counters are those of the last view
+        if (tileStats) {
+            printTileStatsSummary(summarizeTileStats(lastTileStats));
+            const std::pair<TileMetric, const char*> heatmaps[] = {
+                {TileMetric::Visited, "visited"}, {TileMetric::Contributed, "contributed"}, {TileMetric::SaturatedAt, "saturation"}};
+            for (const auto& heatmap : heatmaps) {
+                const std::string filename = tileStatsPrefix + "_" + heatmap.second + ".png";
+                const RenderRegion& statsRegion = lastTileStatsRegion;
+                const std::vector<uint8_t> pixels = tileStatsHeatmap(lastTileStats, heatmap.first, statsRegion.width, statsRegion.height);
+                stbi_write_png(filename.c_str(), statsRegion.width, statsRegion.height, 4, pixels.data(), statsRegion.width * 4);
+                std::cout << "Tile heatmap written to " << filename << std::endl;
+            }
         }
 
-        stbi_write_png("output.png", width, height, 4, pixelData.data(), width * 4);
-        vkUnmapMemory(vulkan.device, imageBufferMemory);
+        if (gpuBinning) {
+            GpuTileBinner::Stats stats = tileBinner->readStats();
+            std::cout << "GPU tile binning: " << stats.pairCount << " tile/Gaussian pairs, "
+                      << stats.activeTileCount << " tiles non-empty" << std::endl;
+            if (stats.totalPairs > stats.pairCount) {
+                std::cerr << "Warning: " << stats.totalPairs << " pairs were needed, raise --max-pairs" << std::endl;
+            }
+        }
+        bufferPool.printStats();
 
     } catch (const std::exception &e) {
         std::cerr << "Error: " << e.what() << std::endl;
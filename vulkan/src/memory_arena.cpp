@@ -0,0 +1,216 @@
+#include "memory_arena.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+void MemoryArena::init(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize) {
+    this->device = device;
+    this->blockSize = blockSize;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    nonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+}
+
+void MemoryArena::destroy() {
+    for (auto& block : blocks) {
+        if (block.memory == VK_NULL_HANDLE) {
+            continue;
+        }
+        if (block.mapped) {
+            vkUnmapMemory(device, block.memory);
+        }
+        vkFreeMemory(device, block.memory, nullptr);
+    }
+    blocks.clear();
+}
+
+uint32_t MemoryArena::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+uint32_t MemoryArena::createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool linear, bool dedicated) {
+    Block block;
+    block.size = size;
+    block.memoryTypeIndex = memoryTypeIndex;
+    block.hostVisible = (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    block.linear = linear;
+    block.dedicated = dedicated;
+    block.freeRanges[0] = size;
+
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &block.memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate memory arena block!");
+    }
+
+    if (block.hostVisible && vkMapMemory(device, block.memory, 0, VK_WHOLE_SIZE, 0, &block.mapped) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to map memory arena block!");
+    }
+
+    // Reuse the slot of a released dedicated block
+    for (uint32_t i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].memory == VK_NULL_HANDLE) {
+            blocks[i] = std::move(block);
+            return i;
+        }
+    }
+    blocks.push_back(std::move(block));
+    return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+bool MemoryArena::tryAllocate(uint32_t blockIndex, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation) {
+    Block& block = blocks[blockIndex];
+
+    // First fit over the free list
+    for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+        VkDeviceSize rangeStart = it->first;
+        VkDeviceSize rangeEnd = it->first + it->second;
+        VkDeviceSize offset = alignUp(rangeStart, alignment);
+        if (offset + size > rangeEnd) {
+            continue;
+        }
+
+        block.freeRanges.erase(it);
+        if (offset > rangeStart) {
+            block.freeRanges[rangeStart] = offset - rangeStart;
+        }
+        if (offset + size < rangeEnd) {
+            block.freeRanges[offset + size] = rangeEnd - (offset + size);
+        }
+
+        block.allocationCount++;
+        block.usedBytes += size;
+
+        allocation.memory = block.memory;
+        allocation.offset = offset;
+        allocation.size = size;
+        allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + offset : nullptr;
+        allocation.blockIndex = blockIndex;
+        return true;
+    }
+
+    return false;
+}
+
+MemoryArena::Allocation MemoryArena::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+                                              bool linear) {
+    const uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+    const bool hostVisible = (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+
+    // Host-visible ranges are padded to the non-coherent atom so they can be flushed
+    // and invalidated without touching their neighbours
+    VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+    VkDeviceSize size = requirements.size;
+    if (hostVisible) {
+        alignment = std::max(alignment, nonCoherentAtomSize);
+        size = alignUp(size, nonCoherentAtomSize);
+    }
+
+    Allocation allocation;
+    if (size > blockSize) {
+        uint32_t blockIndex = createBlock(memoryTypeIndex, size, linear, true);
+        tryAllocate(blockIndex, size, alignment, allocation);
+        return allocation;
+    }
+
+    for (uint32_t i = 0; i < blocks.size(); ++i) {
+        const Block& block = blocks[i];
+        if (block.memory != VK_NULL_HANDLE && !block.dedicated && block.memoryTypeIndex == memoryTypeIndex &&
+            block.linear == linear && tryAllocate(i, size, alignment, allocation)) {
+            return allocation;
+        }
+    }
+
+    uint32_t blockIndex = createBlock(memoryTypeIndex, blockSize, linear, false);
+    if (!tryAllocate(blockIndex, size, alignment, allocation)) {
+        throw std::runtime_error("Memory arena block cannot hold the allocation!");
+    }
+    return allocation;
+}
+
+void MemoryArena::free(const Allocation& allocation) {
+    if (allocation.memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    Block& block = blocks[allocation.blockIndex];
+    block.allocationCount--;
+    block.usedBytes -= allocation.size;
+
+    // Dedicated blocks hold a single allocation and go straight back to the driver
+    if (block.dedicated) {
+        if (block.mapped) {
+            vkUnmapMemory(device, block.memory);
+        }
+        vkFreeMemory(device, block.memory, nullptr);
+        block = Block();
+        return;
+    }
+
+    // Merge with the free neighbours on both sides
+    VkDeviceSize start = allocation.offset;
+    VkDeviceSize end = allocation.offset + allocation.size;
+
+    auto next = block.freeRanges.lower_bound(start);
+    if (next != block.freeRanges.end() && next->first == end) {
+        end += next->second;
+        next = block.freeRanges.erase(next);
+    }
+    if (next != block.freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == start) {
+            start = previous->first;
+            block.freeRanges.erase(previous);
+        }
+    }
+    block.freeRanges[start] = end - start;
+}
+
+MemoryArena::Stats MemoryArena::getStats() const {
+    Stats stats;
+    for (const auto& block : blocks) {
+        if (block.memory == VK_NULL_HANDLE) {
+            continue;
+        }
+        stats.blockCount++;
+        stats.allocationCount += block.allocationCount;
+        stats.reservedBytes += block.size;
+        stats.usedBytes += block.usedBytes;
+        stats.freeRangeCount += static_cast<uint32_t>(block.freeRanges.size());
+        for (const auto& range : block.freeRanges) {
+            stats.largestFreeRange = std::max(stats.largestFreeRange, range.second);
+        }
+    }
+    return stats;
+}
+
+void MemoryArena::printStats() const {
+    Stats stats = getStats();
+    const double mb = 1024.0 * 1024.0;
+    VkDeviceSize freeBytes = stats.reservedBytes - stats.usedBytes;
+    double fragmentation = freeBytes > 0 ? 1.0 - static_cast<double>(stats.largestFreeRange) / freeBytes : 0.0;
+
+    std::cout << "Memory arena: " << stats.allocationCount << " allocations in " << stats.blockCount << " blocks, "
+              << stats.usedBytes / mb << " / " << stats.reservedBytes / mb << " MB used, "
+              << stats.freeRangeCount << " free ranges (largest " << stats.largestFreeRange / mb
+              << " MB, fragmentation " << fragmentation * 100.0 << "%)" << std::endl;
+}
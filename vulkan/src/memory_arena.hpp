@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <map>
+#include <vector>
+
+// Sub-allocates buffer and image memory from large VkDeviceMemory blocks instead
+// of one vkAllocateMemory per resource. Blocks are kept per memory type and per
+// resource kind (linear buffers vs. optimal-tiling images, so bufferImageGranularity
+// never applies), and each block tracks its free ranges in an offset-ordered free
+// list that is coalesced on free. Requests larger than a block get a dedicated
+// block of their own. Host-visible blocks are mapped once and stay mapped.
+// Shared with the rasterization project.
+class MemoryArena {
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+    struct Allocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        void* mapped = nullptr;   // Host pointer at `offset`, null unless host visible
+        uint32_t blockIndex = 0;
+    };
+
+    // Totals over all live blocks. Fragmentation is 1 - largest free range / free bytes.
+    struct Stats {
+        uint32_t blockCount = 0;
+        uint32_t allocationCount = 0;
+        VkDeviceSize reservedBytes = 0;     // Sum of block sizes
+        VkDeviceSize usedBytes = 0;         // Sum of live allocations, alignment padding excluded
+        uint32_t freeRangeCount = 0;
+        VkDeviceSize largestFreeRange = 0;
+    };
+
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+    // Frees every block; all resources bound to the arena must be destroyed first
+    void destroy();
+
+    // `linear` is false for images created with VK_IMAGE_TILING_OPTIMAL
+    Allocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear = true);
+    void free(const Allocation& allocation);
+
+    Stats getStats() const;
+    void printStats() const;
+
+private:
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;  // Null once a dedicated block has been released
+        VkDeviceSize size = 0;
+        uint32_t memoryTypeIndex = 0;
+        bool hostVisible = false;
+        bool linear = true;
+        bool dedicated = false;
+        void* mapped = nullptr;
+        uint32_t allocationCount = 0;
+        VkDeviceSize usedBytes = 0;
+        std::map<VkDeviceSize, VkDeviceSize> freeRanges;  // offset -> size
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memoryProperties = {};
+    VkDeviceSize nonCoherentAtomSize = 1;
+    VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE;
+    std::vector<Block> blocks;
+
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    uint32_t createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool linear, bool dedicated);
+    bool tryAllocate(uint32_t blockIndex, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation);
+};
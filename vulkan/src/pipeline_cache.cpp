@@ -0,0 +1,149 @@
+#include "pipeline_cache.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+constexpr size_t CACHE_HEADER_SIZE = 16 + VK_UUID_SIZE;
+
+uint32_t readWord(const std::vector<char>& data, size_t offset) {
+    uint32_t value;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+void PipelineCache::init(VkDevice device, VkPhysicalDevice physicalDevice) {
+    this->device = device;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    std::ostringstream name;
+    name << "pipeline_cache_" << std::hex << std::setfill('0');
+    for (uint32_t i = 0; i < VK_UUID_SIZE; ++i) {
+        name << std::setw(2) << static_cast<uint32_t>(properties.pipelineCacheUUID[i]);
+    }
+    name << std::dec << "_" << properties.driverVersion << ".bin";
+    path = name.str();
+
+    auto loadStart = Clock::now();
+    std::vector<char> initialData = readCacheFile(path, properties);
+    hit = !initialData.empty();
+    loadedSize = initialData.size();
+
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = initialData.size();
+    createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+
+    if (hit) {
+        std::cout << "Pipeline cache: loaded " << loadedSize / 1024.0 << " KB from " << path << " in "
+                  << elapsedMs(loadStart, Clock::now()) << " ms" << std::endl;
+    } else {
+        std::cout << "Pipeline cache: no cache for this device and driver (" << path << "), starting empty" << std::endl;
+    }
+}
+
+std::vector<char> PipelineCache::readCacheFile(const std::string& path, const VkPhysicalDeviceProperties& properties) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return {};
+    }
+
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(data.data(), data.size());
+
+    // The driver rejects foreign data on its own, but a mismatch is reported as a miss here
+    if (!file || data.size() < CACHE_HEADER_SIZE ||
+        readWord(data, 0) < CACHE_HEADER_SIZE ||
+        readWord(data, 4) != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        readWord(data, 8) != properties.vendorID ||
+        readWord(data, 12) != properties.deviceID ||
+        std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return {};
+    }
+    return data;
+}
+
+void PipelineCache::destroy() {
+    if (cache == VK_NULL_HANDLE) {
+        return;
+    }
+
+    size_t size = 0;
+    vkGetPipelineCacheData(device, cache, &size, nullptr);
+
+    // Nothing new was compiled, leave the file alone
+    if (size > 0 && !(hit && size == loadedSize)) {
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(device, cache, &size, data.data()) == VK_SUCCESS) {
+            // Concurrent processes share the file, so write a private copy and rename it into place
+            std::ostringstream tempPath;
+            tempPath << path << ".tmp" << std::hex << std::random_device{}();
+
+            std::ofstream file(tempPath.str(), std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(size));
+            file.close();
+
+            if (!file || std::rename(tempPath.str().c_str(), path.c_str()) != 0) {
+                std::remove(tempPath.str().c_str());
+                std::cerr << "Failed to save pipeline cache to " << path << std::endl;
+            } else {
+                std::cout << "Pipeline cache: saved " << size / 1024.0 << " KB to " << path << std::endl;
+            }
+        }
+    }
+
+    vkDestroyPipelineCache(device, cache, nullptr);
+    cache = VK_NULL_HANDLE;
+}
+
+VkResult PipelineCache::createComputePipeline(const VkComputePipelineCreateInfo& createInfo, VkPipeline& pipeline) {
+    auto start = Clock::now();
+    VkResult result = vkCreateComputePipelines(device, cache, 1, &createInfo, nullptr, &pipeline);
+    const double ms = elapsedMs(start, Clock::now());
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    creationMs += ms;
+    pipelineCount++;
+    return result;
+}
+
+VkResult PipelineCache::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline& pipeline) {
+    auto start = Clock::now();
+    VkResult result = vkCreateGraphicsPipelines(device, cache, 1, &createInfo, nullptr, &pipeline);
+    const double ms = elapsedMs(start, Clock::now());
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    creationMs += ms;
+    pipelineCount++;
+    return result;
+}
+
+void PipelineCache::printStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    std::cout << "Pipeline cache " << (hit ? "hit" : "miss") << ": " << pipelineCount << " pipelines created in "
+              << creationMs << " ms" << std::endl;
+}
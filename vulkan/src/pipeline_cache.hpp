@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// VkPipelineCache persisted in the working directory, so the driver does not
+// recompile every shader on each process start. The file name is keyed by the
+// device's pipelineCacheUUID and driver version; a missing or mismatching file
+// starts an empty cache. Pipelines created through it are timed for the startup
+// log. Shared with the rasterization project.
+class PipelineCache {
+public:
+    void init(VkDevice device, VkPhysicalDevice physicalDevice);
+    // Writes the cache back when the driver added to it, then destroys it
+    void destroy();
+
+    VkPipelineCache get() const { return cache; }
+
+    // Both can be called from several threads at once (the VkPipelineCache synchronizes itself)
+    VkResult createComputePipeline(const VkComputePipelineCreateInfo& createInfo, VkPipeline& pipeline);
+    VkResult createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline& pipeline);
+
+    // Hit or miss, and the time spent creating pipelines so far
+    void printStats() const;
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    std::string path;
+    bool hit = false;
+    size_t loadedSize = 0;
+    mutable std::mutex statsMutex; // Guards pipelineCount and creationMs
+    uint32_t pipelineCount = 0;
+    double creationMs = 0.0; // Summed over threads
+
+    static std::vector<char> readCacheFile(const std::string& path, const VkPhysicalDeviceProperties& properties);
+};
@@ -0,0 +1,277 @@
+#include "render_context.hpp"
+#include "utils.hpp"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+RenderContext::RenderContext(VulkanSetup& vulkan, bool subgroupKernel, uint32_t maxTilePairs)
+    : vulkan(vulkan), maxTilePairs(maxTilePairs), bufferPool(vulkan) {
+    registry = std::make_unique<SceneRegistry>(vulkan);
+
+    // Unused by the regular launch, but binding 5 is part of the tiled shaders' interface
+    vulkan.createBuffer(2 * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, tileQueueBuffer);
+    // Same for binding 6, the kernels are built without tile statistics
+    vulkan.createBuffer(4 * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, tileStatsBuffer);
+
+    createDescriptorSet();
+    createPipeline(subgroupKernel);
+    createCommandBuffer();
+}
+
+RenderContext::~RenderContext() {
+    vkDeviceWaitIdle(vulkan.device);
+
+    vkDestroyFence(vulkan.device, fence, nullptr);
+    vkFreeCommandBuffers(vulkan.device, vulkan.commandPool, 1, &commandBuffer);
+    vkDestroyPipeline(vulkan.device, pipeline, nullptr);
+    vkDestroyPipelineLayout(vulkan.device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(vulkan.device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.device, descriptorSetLayout, nullptr);
+
+    vulkan.destroyBuffer(tileQueueBuffer);
+    vulkan.destroyBuffer(tileStatsBuffer);
+}
+
+void RenderContext::createDescriptorSet() {
+    // Gaussians (0), image (1), tile Gaussian indices (2), tile ranges (3), active tiles (4), work queue (5),
+    // tile statistics (6)
+    std::array<VkDescriptorSetLayoutBinding, 7> bindings = {};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create render context descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = bindings.size();
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create render context descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(vulkan.device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate render context descriptor set!");
+    }
+}
+
+void RenderContext::createPipeline(bool subgroupKernel) {
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(vulkan.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create render context pipeline layout!");
+    }
+
+    // The batch size tuned by --autotune for this device, if any
+    const std::string kernelName = subgroupKernel ? "subgroup" : "tiled";
+    loadKernelConfig(kernelConfigPath(vulkan.getDeviceUUID()), kernelName, kernelConfig);
+
+    VkSpecializationInfo specializationInfo = kernelSpecializationInfo(kernelConfig);
+    pipeline = vulkan.createComputePipeline(subgroupKernel ? "../shaders/tile_subgroup_shader.spv" : "../shaders/tile_shader.spv",
+                                            pipelineLayout, &specializationInfo);
+}
+
+void RenderContext::createCommandBuffer() {
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = vulkan.commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(vulkan.device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate render context command buffer!");
+    }
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(vulkan.device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create render context fence!");
+    }
+}
+
+uint32_t RenderContext::addScene(std::vector<SceneGaussian> scene) {
+    return registry->addScene(std::move(scene));
+}
+
+void RenderContext::prepare(uint32_t width, uint32_t height) {
+    bool rebind = false;
+
+    // Preprocessing outputs hold the largest scene, so only a larger one rebuilds them
+    // (and the binner sized by them). They at least double, so a growing set of scenes
+    // only rebuilds a logarithmic number of times.
+    if (!preprocessor || preprocessor->getGaussianCount() < registry->getMaxGaussianCount()) {
+        const uint32_t capacity = preprocessor ? preprocessor->getGaussianCount() * 2 : 0;
+        tileBinner.reset();
+        preprocessor.reset();
+        preprocessor = std::make_unique<GpuPreprocessor>(vulkan, *registry, capacity, &bufferPool);
+        rebind = true;
+    }
+
+    VkRect2D region = {};
+    region.extent = {width, height};
+    if (!tileBinner) {
+        const uint32_t pairs = maxTilePairs > 0 ? maxTilePairs : preprocessor->getGaussianCount() * 8;
+        tileBinner = std::make_unique<GpuTileBinner>(vulkan, preprocessor->getGaussianBuffer(), preprocessor->getDepthBuffer(),
+                                                     preprocessor->getGaussianCount(), region, pairs, false, 0, &bufferPool);
+        rebind = true;
+    } else if (width != imageWidth || height != imageHeight) {
+        // Keeps the binner's pipelines and pair buffers; the tile buffers only grow
+        tileBinner->setRegion(region);
+        rebind = true;
+    }
+    imageWidth = width;
+    imageHeight = height;
+
+    if (rebind) {
+        updateDescriptorSet();
+    }
+}
+
+void RenderContext::updateDescriptorSet() {
+    // Binding 1 follows the pooled image buffer, see updateImageBinding
+    const std::array<uint32_t, 6> bindings = {0, 2, 3, 4, 5, 6};
+    std::array<VkDescriptorBufferInfo, 6> bufferInfos = {};
+    bufferInfos[0] = {preprocessor->getGaussianBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[1] = {tileBinner->getTileGaussianBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[2] = {tileBinner->getTileRangeBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[3] = {tileBinner->getActiveTileBuffer(), 0, VK_WHOLE_SIZE};
+    bufferInfos[4] = {tileQueueBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[5] = {tileStatsBuffer, 0, VK_WHOLE_SIZE};
+
+    std::array<VkWriteDescriptorSet, 6> descriptorWrites = {};
+    for (uint32_t i = 0; i < descriptorWrites.size(); ++i) {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = descriptorSet;
+        descriptorWrites[i].dstBinding = bindings[i];
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(vulkan.device, descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+}
+
+void RenderContext::updateImageBinding() {
+    VkDescriptorBufferInfo bufferInfo = {imageBuffer, 0, VK_WHOLE_SIZE};
+
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = 1;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(vulkan.device, 1, &descriptorWrite, 0, nullptr);
+}
+
+void RenderContext::render(uint32_t sceneIndex, const Camera& camera, std::vector<float>& output) {
+    if (sceneIndex >= registry->getSceneCount()) {
+        throw std::runtime_error("Cannot render scene " + std::to_string(sceneIndex) + ", it was never added!");
+    }
+
+    prepare(camera.width, camera.height);
+
+    // Pooled buffers: the same ones every render once the largest image size has been seen
+    const uint64_t frame = ++renderCount;
+    const VkDeviceSize imageBufferSize = static_cast<VkDeviceSize>(imageWidth) * imageHeight * 4 * sizeof(float);
+    VkBuffer frameImageBuffer = bufferPool.acquire(imageBufferSize,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame);
+    VkBuffer readbackBuffer = bufferPool.acquireReadback(imageBufferSize, frame);
+    if (frameImageBuffer != imageBuffer) {
+        imageBuffer = frameImageBuffer;
+        updateImageBinding();
+    }
+
+    // The previous render has been waited on, so the uniform buffer is free to rewrite
+    preprocessor->setCameras({camera});
+
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    preprocessor->record(commandBuffer, sceneIndex);
+    tileBinner->record(commandBuffer);
+
+    // Only non-empty tiles are launched, the rest of the image stays cleared
+    vkCmdFillBuffer(commandBuffer, imageBuffer, 0, imageBufferSize, 0);
+    transferToComputeBarrier(commandBuffer);
+
+    const PushConstants pc = {{static_cast<int32_t>(imageWidth), static_cast<int32_t>(imageHeight)},
+                              {0, 0},
+                              {static_cast<int32_t>(imageWidth), static_cast<int32_t>(imageHeight)}};
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+    vkCmdDispatchIndirect(commandBuffer, tileBinner->getDispatchBuffer(), tileBinner->getSplatDispatchOffset());
+
+    computeToTransferBarrier(commandBuffer);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.size = imageBufferSize;
+    vkCmdCopyBuffer(commandBuffer, imageBuffer, readbackBuffer, 1, &copyRegion);
+
+    // The fence alone does not make the copy visible to the mapped readback buffer
+    transferToHostBarrier(commandBuffer);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(vulkan.computeQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit render context command buffer!");
+    }
+
+    vkWaitForFences(vulkan.device, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(vulkan.device, 1, &fence);
+
+    vulkan.invalidateBuffer(readbackBuffer);
+    output.resize(static_cast<size_t>(imageWidth) * imageHeight * 4);
+    std::memcpy(output.data(), vulkan.mapBuffer(readbackBuffer), imageBufferSize);
+
+    bufferPool.recycle(frame);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include "file_loader.hpp"
+#include "scene_registry.hpp"
+#include "gpu_preprocess.hpp"
+#include "gpu_tile_binning.hpp"
+#include "kernel_config.hpp"
+#include "transient_buffer_pool.hpp"
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <vector>
+
+// The GPU-binned tiled renderer behind one call: scenes are registered once, and
+// render() preprocesses, bins and splats a scene for a camera and reads the image back.
+// The splatting descriptor set, pipeline layout, pipeline, command buffer and fence are
+// built by the constructor. The preprocessing outputs and tile lists are built by the
+// first render() that needs them and kept while later renders fit: a larger scene
+// rebuilds them at least twice as large, a new image size only re-targets the binner
+// and rebinds. The image and readback buffers come from a TransientBufferPool recycled
+// under the fence; the preprocessing outputs and the binner's scratch buffers are held
+// from the same pool, so a rebuild reuses whatever still fits. A repeated render of the
+// same scene only records, submits and reads back.
+class RenderContext {
+public:
+    // `subgroupKernel` selects tile_subgroup_shader.glsl over tile_shader.glsl.
+    // `maxTilePairs` is the binning capacity, 0 = 8 per Gaussian.
+    RenderContext(VulkanSetup& vulkan, bool subgroupKernel = false, uint32_t maxTilePairs = 0);
+    ~RenderContext();
+
+    // Uploads a scene and returns the index render() takes
+    uint32_t addScene(std::vector<SceneGaussian> scene);
+
+    // Renders the whole image of `camera` and blocks until `output` holds it as
+    // camera.width * camera.height RGBA floats
+    void render(uint32_t sceneIndex, const Camera& camera, std::vector<float>& output);
+
+    const SceneRegistry& getSceneRegistry() const { return *registry; }
+    const KernelConfig& getKernelConfig() const { return kernelConfig; }
+    const TransientBufferPool& getBufferPool() const { return bufferPool; }
+
+private:
+    // Same layout as the tiled shaders' push constants
+    struct PushConstants {
+        int32_t imageSize[2];
+        int32_t regionOffset[2];
+        int32_t regionSize[2];
+    };
+
+    VulkanSetup& vulkan;
+    uint32_t maxTilePairs;
+    KernelConfig kernelConfig;
+
+    // Declared in dependency order, so the binner goes first and the pool last
+    TransientBufferPool bufferPool;
+    std::unique_ptr<SceneRegistry> registry;
+    std::unique_ptr<GpuPreprocessor> preprocessor;
+    std::unique_ptr<GpuTileBinner> tileBinner;
+
+    // Image size the tile lists are set up for, 0x0 before the first render
+    uint32_t imageWidth = 0;
+    uint32_t imageHeight = 0;
+    uint64_t renderCount = 0;                   // Frame value of the pool
+    VkBuffer imageBuffer = VK_NULL_HANDLE;      // Bound to binding 1
+    VkBuffer tileQueueBuffer;
+    VkBuffer tileStatsBuffer;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSet;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+
+    void createDescriptorSet();
+    void createPipeline(bool subgroupKernel);
+    void createCommandBuffer();
+
+    // Rebuilds whatever no longer fits the registry's scenes or the image size
+    void prepare(uint32_t width, uint32_t height);
+    void updateDescriptorSet();
+    void updateImageBinding();
+};
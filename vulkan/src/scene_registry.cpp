@@ -0,0 +1,145 @@
+#include "scene_registry.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+SceneRegistry::SceneRegistry(VulkanSetup& vulkan, StreamingUploader* uploader) : vulkan(vulkan), uploader(uploader) {
+    if (!vulkan.supportsDescriptorIndexing()) {
+        throw std::runtime_error("Descriptor indexing (runtime arrays, partially bound, update after bind) is not supported!");
+    }
+
+    createDescriptorSet();
+}
+
+SceneRegistry::~SceneRegistry() {
+    vkDeviceWaitIdle(vulkan.device);
+
+    vkDestroyDescriptorPool(vulkan.device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(vulkan.device, descriptorSetLayout, nullptr);
+
+    for (VkBuffer buffer : sceneBuffers) {
+        vulkan.destroyBuffer(buffer);
+    }
+}
+
+void SceneRegistry::createDescriptorSet() {
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = MAX_SCENES;
+    binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // Unused slots are never read; new scenes are written while the set is bound
+    VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo = {};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = 1;
+    flagsInfo.pBindingFlags = &bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &flagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    if (vkCreateDescriptorSetLayout(vulkan.device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create scene registry descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = MAX_SCENES;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(vulkan.device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create scene registry descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(vulkan.device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate scene registry descriptor set!");
+    }
+}
+
+uint32_t SceneRegistry::addScene(std::vector<SceneGaussian> scene) {
+    if (scene.empty()) {
+        throw std::runtime_error("Cannot register an empty scene!");
+    }
+    if (sceneBuffers.size() >= MAX_SCENES) {
+        throw std::runtime_error("Scene registry is full!");
+    }
+
+    const uint32_t sceneIndex = getSceneCount();
+
+    const VkDeviceSize sceneSize = sizeof(SceneGaussian) * scene.size();
+    VkBuffer sceneBuffer;
+    if (uploader) {
+        vulkan.createBuffer(sceneSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sceneBuffer, true);
+    } else {
+        vulkan.createDeviceLocalBuffer(sceneSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, scene.data(), sceneBuffer);
+    }
+    sceneBuffers.push_back(sceneBuffer);
+    gaussianCounts.push_back(static_cast<uint32_t>(scene.size()));
+
+    // The vector's heap block does not move with it, so the uploader's pointer stays valid
+    if (uploader) {
+        uploadIds.push_back(uploader->enqueue(sceneBuffer, scene.data(), sceneSize));
+        streamingData.push_back(std::move(scene));
+    }
+
+    VkDescriptorBufferInfo bufferInfo = {sceneBuffer, 0, VK_WHOLE_SIZE};
+
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.dstArrayElement = sceneIndex;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(vulkan.device, 1, &descriptorWrite, 0, nullptr);
+
+    return sceneIndex;
+}
+
+bool SceneRegistry::pump() {
+    if (!uploader) {
+        return false;
+    }
+
+    bool pending = uploader->pump();
+    for (uint32_t i = 0; i < streamingData.size(); ++i) {
+        if (!streamingData[i].empty() && uploader->isResident(uploadIds[i])) {
+            std::vector<SceneGaussian>().swap(streamingData[i]);
+        }
+    }
+    return pending;
+}
+
+uint32_t SceneRegistry::getResidentGaussianCount(uint32_t sceneIndex) const {
+    if (!uploader) {
+        return gaussianCounts.at(sceneIndex);
+    }
+    return static_cast<uint32_t>(uploader->residentBytes(uploadIds.at(sceneIndex)) / sizeof(SceneGaussian));
+}
+
+uint32_t SceneRegistry::getMaxGaussianCount() const {
+    if (gaussianCounts.empty()) {
+        return 0;
+    }
+    return *std::max_element(gaussianCounts.begin(), gaussianCounts.end());
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include "file_loader.hpp"
+#include "streaming_uploader.hpp"
+#include <vulkan/vulkan.h>
+#include <vector>
+
+// Keeps several 3D scenes resident on the device at once. Every scene buffer is an
+// element of one bindless storage buffer array (descriptor indexing), so a pass bound
+// to the registry's set picks its scene with a push-constant index: switching scenes
+// needs no upload, no descriptor update and no rebinding.
+//
+// With a StreamingUploader, scenes are uploaded in chunks behind the caller's back and
+// become resident as a growing prefix of their Gaussians; passes only read the
+// resident part (getResidentGaussianCount) and their submissions wait on getUploader().
+class SceneRegistry {
+public:
+    // Length of the descriptor array; slots past getSceneCount() stay unbound
+    static constexpr uint32_t MAX_SCENES = 64;
+
+    // `uploader` (optional) has to outlive the registry
+    explicit SceneRegistry(VulkanSetup& vulkan, StreamingUploader* uploader = nullptr);
+    ~SceneRegistry();
+
+    // Uploads a scene into the next free slot and returns its index. The set is
+    // update-after-bind, so this is allowed while passes using other slots are pending.
+    // When streaming, the scene is kept on the host until it is resident.
+    uint32_t addScene(std::vector<SceneGaussian> scene);
+
+    // Advances streaming uploads and frees the host copies of scenes that are resident.
+    // Returns true while uploads are pending; a no-op without an uploader.
+    bool pump();
+
+    uint32_t getSceneCount() const { return static_cast<uint32_t>(sceneBuffers.size()); }
+    uint32_t getGaussianCount(uint32_t sceneIndex) const { return gaussianCounts.at(sceneIndex); }
+    // Gaussians already on the device as of the last pump, all of them without streaming
+    uint32_t getResidentGaussianCount(uint32_t sceneIndex) const;
+    const StreamingUploader* getUploader() const { return uploader; }
+    // Largest scene so far, what per-Gaussian output buffers have to hold
+    uint32_t getMaxGaussianCount() const;
+
+    // Binding 0: `SceneBuffer { float sceneData[]; } scenes[]` in the shaders
+    VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
+    VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+
+private:
+    VulkanSetup& vulkan;
+    StreamingUploader* uploader;
+
+    std::vector<VkBuffer> sceneBuffers;
+    std::vector<uint32_t> gaussianCounts;
+    std::vector<uint32_t> uploadIds;                       // Streaming upload per scene
+    std::vector<std::vector<SceneGaussian>> streamingData; // Host copies until resident
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSet;
+
+    void createDescriptorSet();
+};
@@ -0,0 +1,179 @@
+#include "vulkan_setup.hpp"
+#include "gpu_radix_sort.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Checks and times GpuRadixSort: sorts random 32- and 64-bit keys on the device and
+// compares the result with std::stable_sort. Run from the build directory, like
+// VulkanCompute, so the shaders are found under ../shaders.
+//
+//   ./sort_test [count]   (default 1000000 pairs)
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static void check(VkResult result, const char* what) {
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(std::string("Failed to ") + what + " (VkResult " + std::to_string(result) + ")!");
+    }
+}
+
+// Sorts `count` random keys (value = original index) with GpuRadixSort and checks the
+// result against std::stable_sort, then times a few more runs of the same sort.
+static bool runSortTest(VulkanSetup& vulkan, uint32_t count, uint32_t keyBits) {
+    const uint32_t keyWords = keyBits / 32;
+    const int iterations = 10;
+
+    std::vector<uint32_t> keys(static_cast<size_t>(count) * keyWords);
+    std::mt19937_64 rng(1234 + keyBits);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t key = rng();
+        keys[i * keyWords] = static_cast<uint32_t>(key);
+        if (keyWords == 2) {
+            keys[i * keyWords + 1] = static_cast<uint32_t>(key >> 32);
+        }
+    }
+    auto keyAt = [&](uint32_t i) {
+        return keyWords == 2 ? (static_cast<uint64_t>(keys[i * 2 + 1]) << 32) | keys[i * 2] : keys[i];
+    };
+
+    std::vector<uint32_t> expected(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        expected[i] = i;
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](uint32_t a, uint32_t b) { return keyAt(a) < keyAt(b); });
+
+    VkDeviceSize keySize = sizeof(uint32_t) * keys.size();
+    VkDeviceSize valueSize = sizeof(uint32_t) * static_cast<VkDeviceSize>(count);
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    // Device-local pairs, so the timing is not bound by host memory
+    VkBuffer keyBuffer, valueBuffer;
+    vulkan.createBuffer(keySize, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, keyBuffer);
+    vulkan.createBuffer(valueSize, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, valueBuffer);
+
+    std::vector<uint32_t> indices(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        indices[i] = i;
+    }
+    auto uploadInput = [&]() {
+        vulkan.uploadBuffer(keyBuffer, keys.data(), keySize);
+        vulkan.uploadBuffer(valueBuffer, indices.data(), valueSize);
+    };
+
+    // Reads a device-local buffer back through a host-cached staging buffer
+    auto readBack = [&](VkBuffer buffer, VkDeviceSize size) {
+        VkBuffer readbackBuffer;
+        vulkan.createReadbackBuffer(size, readbackBuffer);
+        vulkan.copyBuffer(buffer, readbackBuffer, size);
+
+        std::vector<uint32_t> result(size / sizeof(uint32_t));
+        vulkan.invalidateBuffer(readbackBuffer);
+        std::memcpy(result.data(), vulkan.mapBuffer(readbackBuffer), size);
+
+        vulkan.destroyBuffer(readbackBuffer);
+        return result;
+    };
+
+    bool passed = true;
+    {
+        GpuRadixSort sort(vulkan, keyBuffer, valueBuffer, count, keyBits);
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = vulkan.commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        check(vkAllocateCommandBuffers(vulkan.device, &allocInfo, &commandBuffer), "allocate the sort command buffer");
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        check(vkBeginCommandBuffer(commandBuffer, &beginInfo), "begin the sort command buffer");
+        sort.record(commandBuffer, count);
+        computeToTransferBarrier(commandBuffer);
+        check(vkEndCommandBuffer(commandBuffer), "record the sort command buffer");
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkFence fence;
+        check(vkCreateFence(vulkan.device, &fenceInfo, nullptr, &fence), "create the sort fence");
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+
+        // The first run is checked, the others are only timed
+        double totalMs = 0.0;
+        for (int iteration = 0; iteration <= iterations; ++iteration) {
+            uploadInput();
+            auto start = Clock::now();
+            check(vkQueueSubmit(vulkan.computeQueue, 1, &submitInfo, fence), "submit the sort");
+            check(vkWaitForFences(vulkan.device, 1, &fence, VK_TRUE, UINT64_MAX), "wait for the sort");
+            check(vkResetFences(vulkan.device, 1, &fence), "reset the sort fence");
+            auto end = Clock::now();
+
+            if (iteration == 0) {
+                const std::vector<uint32_t> sortedKeys = readBack(keyBuffer, keySize);
+                const std::vector<uint32_t> sortedValues = readBack(valueBuffer, valueSize);
+                for (uint32_t i = 0; i < count && passed; ++i) {
+                    bool keyMatches = true;
+                    for (uint32_t w = 0; w < keyWords; ++w) {
+                        keyMatches = keyMatches && sortedKeys[i * keyWords + w] == keys[expected[i] * keyWords + w];
+                    }
+                    if (!keyMatches || sortedValues[i] != expected[i]) {
+                        std::cerr << keyBits << "-bit sort mismatch at " << i << ": value " << sortedValues[i]
+                                  << ", expected " << expected[i] << std::endl;
+                        passed = false;
+                    }
+                }
+            } else {
+                totalMs += elapsedMs(start, end);
+            }
+        }
+
+        double averageMs = totalMs / iterations;
+        std::cout << keyBits << "-bit keys, " << count << " pairs: " << (passed ? "PASSED" : "FAILED")
+                  << ", " << averageMs << " ms, " << (count / 1000.0) / averageMs << " Mkeys/s" << std::endl;
+
+        vkDestroyFence(vulkan.device, fence, nullptr);
+        vkFreeCommandBuffers(vulkan.device, vulkan.commandPool, 1, &commandBuffer);
+    }
+
+    vulkan.destroyBuffer(keyBuffer);
+    vulkan.destroyBuffer(valueBuffer);
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    try {
+        const uint32_t count = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 1000000u;
+        if (count == 0) {
+            throw std::runtime_error("The sort test needs at least one pair");
+        }
+
+        VulkanSetup vulkan({"../shaders/sort_setup.spv", "../shaders/sort_histogram.spv", "../shaders/sort_scatter.spv",
+                            "../shaders/prefix_scan.spv", "../shaders/prefix_add.spv"});
+        bool passed = runSortTest(vulkan, count, 32);
+        passed = runSortTest(vulkan, count, 64) && passed;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
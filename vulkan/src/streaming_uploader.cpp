@@ -0,0 +1,137 @@
+#include "streaming_uploader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+StreamingUploader::StreamingUploader(VulkanSetup& vulkan, VkDeviceSize chunkSize, uint32_t ringSize)
+    : vulkan(vulkan), chunkSize(chunkSize), ring(ringSize) {
+    if (chunkSize == 0 || ringSize == 0) {
+        throw std::runtime_error("Streaming uploads need a chunk size and at least one staging buffer!");
+    }
+
+    timeline = vulkan.createTimelineSemaphore();
+
+    std::vector<VkCommandBuffer> commandBuffers(ringSize);
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = vulkan.transferCommandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = ringSize;
+
+    if (vkAllocateCommandBuffers(vulkan.device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate streaming upload command buffers!");
+    }
+
+    for (uint32_t i = 0; i < ringSize; ++i) {
+        vulkan.createBuffer(chunkSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            ring[i].buffer);
+        ring[i].commandBuffer = commandBuffers[i];
+    }
+}
+
+StreamingUploader::~StreamingUploader() {
+    // Copies still in flight read the staging buffers
+    vulkan.waitTimelineSemaphore(timeline, nextValue - 1);
+
+    for (auto& slot : ring) {
+        vkFreeCommandBuffers(vulkan.device, vulkan.transferCommandPool, 1, &slot.commandBuffer);
+        vulkan.destroyBuffer(slot.buffer);
+    }
+    vkDestroySemaphore(vulkan.device, timeline, nullptr);
+}
+
+uint32_t StreamingUploader::enqueue(VkBuffer dstBuffer, const void* data, VkDeviceSize size) {
+    Upload upload = {};
+    upload.dstBuffer = dstBuffer;
+    upload.data = static_cast<const char*>(data);
+    upload.size = size;
+
+    const uint32_t id = static_cast<uint32_t>(uploads.size());
+    uploads.push_back(upload);
+    if (size > 0) {
+        pendingUploads.push_back(id);
+    }
+    return id;
+}
+
+bool StreamingUploader::pump() {
+    vkGetSemaphoreCounterValue(vulkan.device, timeline, &completedValue);
+
+    // Copies finish in submission order, so every retired chunk extends its upload's prefix
+    for (auto& slot : ring) {
+        if (slot.signalValue != 0 && slot.signalValue <= completedValue) {
+            uploads[slot.upload].residentBytes += slot.size;
+            slot.signalValue = 0;
+        }
+    }
+
+    for (auto& slot : ring) {
+        if (pendingUploads.empty()) {
+            break;
+        }
+        if (slot.signalValue == 0) {
+            submitChunk(slot);
+        }
+    }
+
+    return std::any_of(uploads.begin(), uploads.end(), [](const Upload& upload) {
+        return upload.residentBytes < upload.size;
+    });
+}
+
+void StreamingUploader::flush() {
+    while (pump()) {
+        vulkan.waitTimelineSemaphore(timeline, nextValue - 1);
+    }
+}
+
+void StreamingUploader::submitChunk(StagingSlot& slot) {
+    const uint32_t id = pendingUploads.front();
+    Upload& upload = uploads[id];
+
+    const VkDeviceSize offset = upload.submittedBytes;
+    const VkDeviceSize size = std::min(chunkSize, upload.size - offset);
+    std::memcpy(vulkan.mapBuffer(slot.buffer), upload.data + offset, static_cast<size_t>(size));
+
+    upload.submittedBytes += size;
+    if (upload.submittedBytes == upload.size) {
+        pendingUploads.pop_front();
+    }
+
+    vkResetCommandBuffer(slot.commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.dstOffset = offset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(slot.commandBuffer, slot.buffer, upload.dstBuffer, 1, &copyRegion);
+
+    vkEndCommandBuffer(slot.commandBuffer);
+
+    slot.signalValue = nextValue++;
+    slot.upload = id;
+    slot.size = size;
+
+    // The semaphore signal makes the copy available to the queues that wait on it
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &slot.signalValue;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timeline;
+
+    if (vkQueueSubmit(vulkan.transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit streaming upload chunk!");
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <vector>
+
+// Uploads large buffers in fixed-size chunks through a ring of staging buffers on the
+// transfer queue, without blocking the caller. pump() refills the staging buffers whose
+// copies have finished and submits the next chunks, so it is meant to be called once per
+// frame while rendering goes on. Chunks land in order, so each upload becomes resident as
+// a growing prefix; residentBytes() reports it as of the last pump.
+//
+// Consumers on other queues have to wait on getTimeline() >= getCompletedValue() (which
+// never stalls, the copies have finished) to see the resident bytes. Destination buffers
+// need TRANSFER_DST usage and transferQueueAccess (concurrent sharing).
+class StreamingUploader {
+public:
+    StreamingUploader(VulkanSetup& vulkan, VkDeviceSize chunkSize, uint32_t ringSize = 3);
+    ~StreamingUploader();
+
+    // Queues `size` bytes of `data` for `dstBuffer` and returns the upload's id. `data`
+    // has to stay valid until the upload is resident.
+    uint32_t enqueue(VkBuffer dstBuffer, const void* data, VkDeviceSize size);
+
+    // Retires finished chunks and submits new ones into the free staging buffers.
+    // Returns true while uploads are still pending.
+    bool pump();
+    // Pumps until every queued upload is resident
+    void flush();
+
+    VkDeviceSize residentBytes(uint32_t upload) const { return uploads.at(upload).residentBytes; }
+    bool isResident(uint32_t upload) const { return uploads.at(upload).residentBytes == uploads.at(upload).size; }
+
+    VkSemaphore getTimeline() const { return timeline; }
+    uint64_t getCompletedValue() const { return completedValue; }
+
+private:
+    struct Upload {
+        VkBuffer dstBuffer;
+        const char* data;
+        VkDeviceSize size;
+        VkDeviceSize submittedBytes = 0;
+        VkDeviceSize residentBytes = 0;
+    };
+
+    // A staging buffer and the chunk it carries, busy until the timeline reaches signalValue
+    struct StagingSlot {
+        VkBuffer buffer;
+        VkCommandBuffer commandBuffer;
+        uint64_t signalValue = 0; // 0 when free
+        uint32_t upload = 0;
+        VkDeviceSize size = 0;
+    };
+
+    VulkanSetup& vulkan;
+    VkDeviceSize chunkSize;
+
+    std::vector<Upload> uploads;
+    std::deque<uint32_t> pendingUploads; // Uploads with bytes left to submit, oldest first
+    std::vector<StagingSlot> ring;
+
+    VkSemaphore timeline;
+    uint64_t nextValue = 1;
+    uint64_t completedValue = 0;
+
+    void submitChunk(StagingSlot& slot);
+};
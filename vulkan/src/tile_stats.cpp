@@ -0,0 +1,129 @@
+#include "tile_stats.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t TILE_SIZE = 16;
+
+uint32_t metricValue(const TileStats& tile, TileMetric metric) {
+    switch (metric) {
+    case TileMetric::Visited:
+        return tile.visited;
+    case TileMetric::Contributed:
+        return tile.contributed;
+    case TileMetric::SaturatedAt:
+        return tile.saturatedAt;
+    }
+    return 0;
+}
+
+TileStatsSummary::Metric summarize(std::vector<uint32_t> values) {
+    TileStatsSummary::Metric metric;
+    if (values.empty()) {
+        return metric;
+    }
+
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (uint32_t value : values) {
+        sum += value;
+    }
+    metric.mean = sum / values.size();
+    metric.p99 = values[(values.size() * 99 + 99) / 100 - 1];
+    metric.max = values.back();
+    return metric;
+}
+
+// Blue - cyan - green - yellow - red
+void colormap(float t, uint8_t* rgba) {
+    const float stops[5][3] = {{0, 0, 1}, {0, 1, 1}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}};
+    const float position = std::min(std::max(t, 0.0f), 1.0f) * 4.0f;
+    const int stop = std::min(static_cast<int>(position), 3);
+    const float blend = position - stop;
+    for (int c = 0; c < 3; ++c) {
+        const float value = stops[stop][c] + (stops[stop + 1][c] - stops[stop][c]) * blend;
+        rgba[c] = static_cast<uint8_t>(value * 255.0f);
+    }
+    rgba[3] = 255;
+}
+
+void printMetric(const char* name, const TileStatsSummary::Metric& metric) {
+    std::cout << "  " << name << ": mean " << metric.mean << ", p99 " << metric.p99 << ", max " << metric.max << std::endl;
+}
+
+} // namespace
+
+TileStatsSummary summarizeTileStats(const std::vector<TileStats>& stats) {
+    TileStatsSummary summary;
+    std::vector<uint32_t> visited, contributed, saturatedAt;
+    for (const TileStats& tile : stats) {
+        if (tile.listLength == 0) {
+            continue;
+        }
+        ++summary.tileCount;
+        visited.push_back(tile.visited);
+        contributed.push_back(tile.contributed);
+        if (tile.saturatedAt == TILE_NEVER_SATURATED) {
+            ++summary.unsaturatedTiles;
+        } else {
+            saturatedAt.push_back(tile.saturatedAt);
+        }
+    }
+
+    summary.visited = summarize(visited);
+    summary.contributed = summarize(contributed);
+    summary.saturatedAt = summarize(saturatedAt);
+    return summary;
+}
+
+void printTileStatsSummary(const TileStatsSummary& summary) {
+    std::cout << "Tile statistics over " << summary.tileCount << " non-empty tiles:" << std::endl;
+    printMetric("visited", summary.visited);
+    printMetric("contributed", summary.contributed);
+    printMetric("saturated at", summary.saturatedAt);
+    std::cout << "  " << summary.unsaturatedTiles << " tiles with pixels that never saturated" << std::endl;
+}
+
+std::vector<uint8_t> tileStatsHeatmap(const std::vector<TileStats>& stats, TileMetric metric,
+                                      uint32_t regionWidth, uint32_t regionHeight) {
+    const uint32_t tilesX = (regionWidth + TILE_SIZE - 1) / TILE_SIZE;
+    const uint32_t tilesY = (regionHeight + TILE_SIZE - 1) / TILE_SIZE;
+    if (stats.size() < static_cast<size_t>(tilesX) * tilesY) {
+        throw std::runtime_error("Tile statistics do not cover the render region!");
+    }
+
+    uint32_t maxValue = 0;
+    for (const TileStats& tile : stats) {
+        const uint32_t value = metricValue(tile, metric);
+        if (tile.listLength > 0 && value != TILE_NEVER_SATURATED) {
+            maxValue = std::max(maxValue, value);
+        }
+    }
+
+    // One color per tile, then spread over the tile's pixels
+    std::vector<uint8_t> tileColors(static_cast<size_t>(tilesX) * tilesY * 4, 0);
+    for (size_t i = 0; i < tileColors.size() / 4; ++i) {
+        uint8_t* rgba = &tileColors[i * 4];
+        rgba[3] = 255;
+        const uint32_t value = metricValue(stats[i], metric);
+        if (stats[i].listLength == 0) {
+            continue;
+        }
+        if (metric == TileMetric::SaturatedAt && value == TILE_NEVER_SATURATED) {
+            std::fill(rgba, rgba + 3, 255);
+            continue;
+        }
+        colormap(maxValue > 0 ? static_cast<float>(value) / maxValue : 0.0f, rgba);
+    }
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(regionWidth) * regionHeight * 4);
+    for (uint32_t y = 0; y < regionHeight; ++y) {
+        for (uint32_t x = 0; x < regionWidth; ++x) {
+            const uint8_t* rgba = &tileColors[((y / TILE_SIZE) * tilesX + x / TILE_SIZE) * 4];
+            std::copy(rgba, rgba + 4, &pixels[(static_cast<size_t>(y) * regionWidth + x) * 4]);
+        }
+    }
+    return pixels;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Per-tile workload counters written by the tiled kernels when they are built with
+// tile statistics (specialization constant 5, --tile-stats). Matches TileStats in
+// tile_shader.glsl and tile_subgroup_shader.glsl, one entry per 16x16 tile of the
+// render region in row-major order. Tiles without Gaussians are never launched and
+// stay zero.
+struct TileStats {
+    uint32_t visited;     // List entries loaded before the tile finished
+    uint32_t contributed; // Gaussians blended into at least one pixel
+    uint32_t saturatedAt; // List entries walked when the last pixel saturated, TILE_NEVER_SATURATED if one never did
+    uint32_t listLength;  // Entries in the tile's list
+};
+static_assert(sizeof(TileStats) == 16, "TileStats has to match the shaders' std430 layout");
+
+constexpr uint32_t TILE_NEVER_SATURATED = 0xffffffffu;
+
+enum class TileMetric {
+    Visited,
+    Contributed,
+    SaturatedAt
+};
+
+struct TileStatsSummary {
+    struct Metric {
+        double mean = 0.0;
+        uint32_t p99 = 0; // Nearest rank
+        uint32_t max = 0;
+    };
+
+    uint32_t tileCount = 0;        // Non-empty tiles, the ones the metrics are taken over
+    uint32_t unsaturatedTiles = 0; // Tiles with a pixel that never saturated, left out of saturatedAt
+    Metric visited;
+    Metric contributed;
+    Metric saturatedAt;
+};
+
+TileStatsSummary summarizeTileStats(const std::vector<TileStats>& stats);
+void printTileStatsSummary(const TileStatsSummary& summary);
+
+// RGBA8 image of the render region with every tile filled by one metric, blue (0) to
+// red (the metric's maximum). Empty tiles are black; in the SaturatedAt map, tiles
+// that never saturated are white.
+std::vector<uint8_t> tileStatsHeatmap(const std::vector<TileStats>& stats, TileMetric metric,
+                                      uint32_t regionWidth, uint32_t regionHeight);
@@ -0,0 +1,115 @@
+#include "transient_buffer_pool.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+TransientBufferPool::TransientBufferPool(VulkanSetup& vulkan) : vulkan(vulkan) {}
+
+TransientBufferPool::~TransientBufferPool() {
+    for (const auto& entry : entries) {
+        vulkan.destroyBuffer(entry.buffer);
+    }
+}
+
+VkBuffer TransientBufferPool::acquire(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, uint64_t frame,
+                                      bool transferQueueAccess) {
+    return acquire(size, usage, properties, false, transferQueueAccess, frame);
+}
+
+VkBuffer TransientBufferPool::acquireReadback(VkDeviceSize size, uint64_t frame) {
+    return acquire(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, 0, true, false, frame);
+}
+
+bool TransientBufferPool::sameKind(const Entry& entry, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, bool readback,
+                                   bool transferQueueAccess) {
+    return entry.readback == readback && entry.usage == usage && (readback || entry.properties == properties) &&
+           entry.transferQueueAccess == transferQueueAccess;
+}
+
+VkBuffer TransientBufferPool::acquire(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                                      bool readback, bool transferQueueAccess, uint64_t frame) {
+    // Smallest free buffer of the same kind that fits
+    Entry* best = nullptr;
+    for (auto& entry : entries) {
+        if (entry.inUse || entry.capacity < size || !sameKind(entry, usage, properties, readback, transferQueueAccess)) {
+            continue;
+        }
+        if (!best || entry.capacity < best->capacity) {
+            best = &entry;
+        }
+    }
+
+    if (best) {
+        ++stats.reuseCount;
+    } else {
+        VkDeviceSize capacity = MIN_CAPACITY;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+
+        // Free buffers of the same kind are all too small, the new one supersedes them
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (!it->inUse && sameKind(*it, usage, properties, readback, transferQueueAccess)) {
+                vulkan.destroyBuffer(it->buffer);
+                --stats.bufferCount;
+                stats.reservedBytes -= it->capacity;
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        Entry entry = {};
+        entry.capacity = capacity;
+        entry.usage = usage;
+        entry.properties = properties;
+        entry.readback = readback;
+        entry.transferQueueAccess = transferQueueAccess;
+        if (readback) {
+            vulkan.createReadbackBuffer(capacity, entry.buffer);
+        } else {
+            vulkan.createBuffer(capacity, usage, properties, entry.buffer, transferQueueAccess);
+        }
+        entries.push_back(entry);
+        best = &entries.back();
+
+        ++stats.allocationCount;
+        ++stats.bufferCount;
+        stats.reservedBytes += capacity;
+        stats.peakReservedBytes = std::max(stats.peakReservedBytes, stats.reservedBytes);
+    }
+
+    best->inUse = true;
+    best->frame = frame;
+    best->requestedSize = size;
+    inUseBytes += size;
+    stats.peakInUseBytes = std::max(stats.peakInUseBytes, inUseBytes);
+    return best->buffer;
+}
+
+void TransientBufferPool::recycle(uint64_t completedFrame) {
+    for (auto& entry : entries) {
+        if (entry.inUse && entry.frame <= completedFrame) {
+            entry.inUse = false;
+            inUseBytes -= entry.requestedSize;
+        }
+    }
+}
+
+void TransientBufferPool::release(VkBuffer buffer) {
+    for (auto& entry : entries) {
+        if (entry.inUse && entry.buffer == buffer) {
+            entry.inUse = false;
+            inUseBytes -= entry.requestedSize;
+            return;
+        }
+    }
+    throw std::runtime_error("Cannot release a buffer the pool has not handed out!");
+}
+
+void TransientBufferPool::printStats() const {
+    std::cout << "Transient buffers: " << stats.bufferCount << " (" << stats.reservedBytes / 1024 << " KiB), "
+              << stats.allocationCount << " allocations, " << stats.reuseCount << " reuses, high water "
+              << stats.peakInUseBytes / 1024 << " KiB in use / " << stats.peakReservedBytes / 1024 << " KiB reserved"
+              << std::endl;
+}
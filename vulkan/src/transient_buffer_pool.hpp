@@ -0,0 +1,72 @@
+#pragma once
+
+#include "vulkan_setup.hpp"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Scratch buffers whose size changes from frame to frame (image, readback, ...). A
+// request is served by the smallest free buffer of the same kind that is large
+// enough; otherwise a new one is created with the size rounded up to a power of two
+// and replaces the free buffers it outgrew, so a growing size only allocates a
+// logarithmic number of times. Buffers handed out
+// for a frame return to the pool once the caller reports that frame as complete
+// (its fence or timeline value), so a steady state allocates nothing. Buffers that
+// live as long as their user (sort keys, tile lists, ...) are held UNTIL_RELEASED.
+class TransientBufferPool {
+public:
+    static constexpr VkDeviceSize MIN_CAPACITY = 64 * 1024;
+    // Frame of buffers that only return to the pool through release()
+    static constexpr uint64_t UNTIL_RELEASED = UINT64_MAX;
+
+    struct Stats {
+        uint32_t bufferCount = 0;          // Buffers owned by the pool
+        uint32_t allocationCount = 0;      // createBuffer calls so far
+        uint32_t reuseCount = 0;           // Requests served by an existing buffer
+        VkDeviceSize reservedBytes = 0;    // Capacity of all buffers
+        VkDeviceSize peakInUseBytes = 0;   // High-water mark of the bytes requested by frames in flight
+        VkDeviceSize peakReservedBytes = 0;
+    };
+
+    explicit TransientBufferPool(VulkanSetup& vulkan);
+    ~TransientBufferPool();
+
+    // A buffer of at least `size` bytes, owned by `frame` until recycle(frame).
+    // `transferQueueAccess` is that of VulkanSetup::createBuffer.
+    VkBuffer acquire(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, uint64_t frame,
+                     bool transferQueueAccess = false);
+    // Same, created with VulkanSetup::createReadbackBuffer
+    VkBuffer acquireReadback(VkDeviceSize size, uint64_t frame);
+
+    // Returns the buffers of every frame up to `completedFrame`; their commands must have finished
+    void recycle(uint64_t completedFrame);
+    // Returns one buffer, whatever frame it was acquired for; its commands must have finished
+    void release(VkBuffer buffer);
+
+    Stats getStats() const { return stats; }
+    void printStats() const;
+
+private:
+    struct Entry {
+        VkBuffer buffer;
+        VkDeviceSize capacity;
+        VkBufferUsageFlags usage;
+        VkMemoryPropertyFlags properties; // Unused for readback buffers
+        bool readback;
+        bool transferQueueAccess;
+        bool inUse = false;
+        uint64_t frame = 0;
+        VkDeviceSize requestedSize = 0;
+    };
+
+    VulkanSetup& vulkan;
+    std::vector<Entry> entries;
+    Stats stats;
+    VkDeviceSize inUseBytes = 0;
+
+    VkBuffer acquire(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, bool readback,
+                     bool transferQueueAccess, uint64_t frame);
+    // Same usage, memory and sharing, so one can stand in for the other
+    static bool sameKind(const Entry& entry, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, bool readback,
+                         bool transferQueueAccess);
+};
@@ -1,18 +1,60 @@
 #include "vulkan_setup.hpp"
+#include "utils.hpp"
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 #include <cstring> // For memcpy
 
-VulkanSetup::VulkanSetup() {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+VulkanSetup::VulkanSetup(const std::vector<std::string>& prefetchShaders) {
+    // The reads need no device, so they run alongside everything below
+    shaderReadMs.assign(prefetchShaders.size(), 0.0);
+    for (size_t i = 0; i < prefetchShaders.size(); ++i) {
+        const std::string& file = prefetchShaders[i];
+        if (shaderPrefetch.count(file) > 0) {
+            continue;
+        }
+        double* readMs = &shaderReadMs[i];
+        shaderPrefetch[file] = std::async(std::launch::async, [file, readMs]() {
+            auto start = Clock::now();
+            std::vector<char> code = readFile(file);
+            *readMs = elapsedMs(start, Clock::now());
+            return code;
+        }).share();
+    }
+    startupTimes.prefetchedShaders = static_cast<uint32_t>(shaderPrefetch.size());
+
+    auto start = Clock::now();
     createInstance();
+    auto instanceEnd = Clock::now();
     pickPhysicalDevice();
     createLogicalDevice();
+    auto deviceEnd = Clock::now();
+    memoryArena.init(device, physicalDevice);
+    pipelineCache.init(device, physicalDevice);
     createCommandPool();
 
+    startupTimes.instanceMs = elapsedMs(start, instanceEnd);
+    startupTimes.deviceMs = elapsedMs(instanceEnd, deviceEnd);
+    startupTimes.resourcesMs = elapsedMs(deviceEnd, Clock::now());
 }
 
 VulkanSetup::~VulkanSetup() {
+    if (transferCommandPool != commandPool) {
+        vkDestroyCommandPool(device, transferCommandPool, nullptr);
+    }
     vkDestroyCommandPool(device, commandPool, nullptr);
+    pipelineCache.destroy();
+    memoryArena.destroy();
     vkDestroyDevice(device, nullptr);
     vkDestroyInstance(instance, nullptr);
 }
@@ -62,30 +104,92 @@ void VulkanSetup::pickPhysicalDevice() {
 }
 
 void VulkanSetup::createLogicalDevice() {
-    uint32_t computeQueueFamilyIndex = findQueueFamily(VK_QUEUE_COMPUTE_BIT);
-
-    VkDeviceQueueCreateInfo queueCreateInfo = {};
-    queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueCreateInfo.queueFamilyIndex = computeQueueFamilyIndex;
-    queueCreateInfo.queueCount = 1;
+    computeQueueFamily = findQueueFamily(VK_QUEUE_COMPUTE_BIT);
+    transferQueueFamily = findTransferQueueFamily(computeQueueFamily);
 
+    // Compute queue, plus a queue of the transfer-only family when there is one
     float queuePriority = 1.0f;
-    queueCreateInfo.pQueuePriorities = &queuePriority;
+    VkDeviceQueueCreateInfo queueCreateInfos[2] = {};
+    for (uint32_t i = 0; i < 2; ++i) {
+        queueCreateInfos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueCreateInfos[i].queueFamilyIndex = i == 0 ? computeQueueFamily : transferQueueFamily;
+        queueCreateInfos[i].queueCount = 1;
+        queueCreateInfos[i].pQueuePriorities = &queuePriority;
+    }
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.pQueueCreateInfos = &queueCreateInfo;
-    createInfo.queueCreateInfoCount = 1;
+    createInfo.pQueueCreateInfos = queueCreateInfos;
+    createInfo.queueCreateInfoCount = hasDedicatedTransferQueue() ? 2 : 1;
 
     // Enable required features if needed
     VkPhysicalDeviceFeatures deviceFeatures = {};
     createInfo.pEnabledFeatures = &deviceFeatures;
 
+    // Timeline semaphores order the compute and transfer submissions of a frame
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+
+    // Bindless storage buffer arrays for the scene registry
+    VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    indexingFeatures.pNext = &timelineFeatures;
+
+    // fp16 arithmetic on 16-bit storage for the half-precision kernel, when the device has both
+    VkPhysicalDevice16BitStorageFeatures storage16Features = {};
+    storage16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
+    storage16Features.pNext = &indexingFeatures;
+    VkPhysicalDeviceShaderFloat16Int8Features float16Features = {};
+    float16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES;
+    float16Features.pNext = &storage16Features;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2) {
+        throw std::runtime_error("Vulkan 1.2 is required for timeline semaphores!");
+    }
+
+    VkPhysicalDeviceFeatures2 supportedFeatures = {};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &float16Features;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures);
+
+    halfArithmeticSupported = float16Features.shaderFloat16 && storage16Features.storageBuffer16BitAccess;
+    pipelineStatisticsSupported = supportedFeatures.features.pipelineStatisticsQuery;
+    deviceFeatures.pipelineStatisticsQuery = pipelineStatisticsSupported;
+    // preprocess_shader.glsl picks the scene's buffer with a push constant, a dynamically
+    // uniform index into the storage buffer array
+    descriptorIndexingSupported = indexingFeatures.runtimeDescriptorArray &&
+        indexingFeatures.descriptorBindingPartiallyBound &&
+        indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind &&
+        supportedFeatures.features.shaderStorageBufferArrayDynamicIndexing;
+    deviceFeatures.shaderStorageBufferArrayDynamicIndexing = descriptorIndexingSupported;
+    if (!timelineFeatures.timelineSemaphore) {
+        throw std::runtime_error("Timeline semaphores are not supported!");
+    }
+
+    indexingFeatures = {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    indexingFeatures.pNext = &timelineFeatures;
+    indexingFeatures.runtimeDescriptorArray = descriptorIndexingSupported;
+    indexingFeatures.descriptorBindingPartiallyBound = descriptorIndexingSupported;
+    indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = descriptorIndexingSupported;
+    float16Features = {};
+    float16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES;
+    float16Features.pNext = &storage16Features;
+    float16Features.shaderFloat16 = halfArithmeticSupported;
+    storage16Features = {};
+    storage16Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
+    storage16Features.pNext = &indexingFeatures;
+    storage16Features.storageBuffer16BitAccess = halfArithmeticSupported;
+    createInfo.pNext = &float16Features;
+
     if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create logical device!");
     }
 
-    vkGetDeviceQueue(device, computeQueueFamilyIndex, 0, &computeQueue);
+    vkGetDeviceQueue(device, computeQueueFamily, 0, &computeQueue);
+    vkGetDeviceQueue(device, transferQueueFamily, 0, &transferQueue);
 
 }
 
@@ -105,40 +209,95 @@ uint32_t VulkanSetup::findQueueFamily(VkQueueFlagBits queueFlags) {
     throw std::runtime_error("Failed to find a suitable queue family!");
 }
 
-uint32_t VulkanSetup::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+uint32_t VulkanSetup::findTransferQueueFamily(uint32_t fallback) {
+    uint32_t queueFamilyCount;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
 
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    for (uint32_t i = 0; i < queueFamilyCount; i++) {
+        const VkQueueFlags flags = queueFamilies[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_COMPUTE_BIT | VK_QUEUE_GRAPHICS_BIT))) {
             return i;
         }
     }
 
-    throw std::runtime_error("Failed to find suitable memory type!");
+    return fallback;
 }
 
-void VulkanSetup::createCommandPool() {
-    // Query the queue family index for compute
-    uint32_t queueFamilyIndex = findQueueFamily(VK_QUEUE_COMPUTE_BIT);
+uint32_t VulkanSetup::getTimestampValidBits(uint32_t queueFamily) const {
+    uint32_t queueFamilyCount;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
 
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    return queueFamily < queueFamilyCount ? queueFamilies[queueFamily].timestampValidBits : 0;
+}
+
+void VulkanSetup::createCommandPool() {
     VkCommandPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    poolInfo.queueFamilyIndex = computeQueueFamily;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
     if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create command pool!");
     }
+
+    transferCommandPool = commandPool;
+    if (hasDedicatedTransferQueue()) {
+        poolInfo.queueFamilyIndex = transferQueueFamily;
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &transferCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create transfer command pool!");
+        }
+    }
+}
+
+VkSemaphore VulkanSetup::createTimelineSemaphore(uint64_t initialValue) {
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = initialValue;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    VkSemaphore semaphore;
+    if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create timeline semaphore!");
+    }
+    return semaphore;
+}
+
+void VulkanSetup::waitTimelineSemaphore(VkSemaphore semaphore, uint64_t value) {
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &semaphore;
+    waitInfo.pValues = &value;
+
+    if (vkWaitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to wait for timeline semaphore!");
+    }
 }
 
 void VulkanSetup::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-                               VkBuffer &buffer, VkDeviceMemory &bufferMemory) {
+                               VkBuffer &buffer, bool transferQueueAccess) {
+    const uint32_t queueFamilies[2] = {computeQueueFamily, transferQueueFamily};
+
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (transferQueueAccess && hasDedicatedTransferQueue()) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = 2;
+        bufferInfo.pQueueFamilyIndices = queueFamilies;
+    }
 
     if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create buffer!");
@@ -147,16 +306,152 @@ void VulkanSetup::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMe
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+    MemoryArena::Allocation allocation = memoryArena.allocate(memRequirements, properties);
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+    bufferAllocations[buffer] = allocation;
+}
+
+void VulkanSetup::destroyBuffer(VkBuffer buffer) {
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    auto it = bufferAllocations.find(buffer);
+    if (it == bufferAllocations.end()) {
+        throw std::runtime_error("Buffer was not created by VulkanSetup!");
+    }
+
+    vkDestroyBuffer(device, buffer, nullptr);
+    memoryArena.free(it->second);
+    bufferAllocations.erase(it);
+}
+
+void* VulkanSetup::mapBuffer(VkBuffer buffer) {
+    auto it = bufferAllocations.find(buffer);
+    if (it == bufferAllocations.end() || !it->second.mapped) {
+        throw std::runtime_error("Buffer is not host visible!");
+    }
+    return it->second.mapped;
+}
+
+void VulkanSetup::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate buffer memory!");
+    VkCommandBuffer commandBuffer;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate copy command buffer!");
     }
 
-    vkBindBufferMemory(device, buffer, bufferMemory, 0);
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // Shader or transfer output of earlier submissions (e.g. a dispatch the caller only
+    // waited on with a fence) must be available before it is copied. Also orders the copy
+    // after earlier accesses of the destination.
+    VkMemoryBarrier sourceBarrier = {};
+    sourceBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    sourceBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    sourceBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &sourceBarrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+
+    // The copied data must be visible to the host (readback) and to shaders and
+    // transfers of later submissions (uploads)
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    // A fence rather than vkQueueWaitIdle, so frames in flight on the queue are not waited for
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create copy fence!");
+    }
+
+    if (vkQueueSubmit(computeQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit copy command buffer!");
+    }
+    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+    vkDestroyFence(device, fence, nullptr);
+    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+}
+
+void VulkanSetup::uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size) {
+    VkBuffer stagingBuffer;
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        stagingBuffer);
+
+    memcpy(mapBuffer(stagingBuffer), data, static_cast<size_t>(size));
+
+    copyBuffer(stagingBuffer, dstBuffer, size);
+
+    destroyBuffer(stagingBuffer);
+}
+
+void VulkanSetup::createDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags usage, const void* data,
+                                          VkBuffer &buffer) {
+    createBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer);
+    uploadBuffer(buffer, data, size);
+}
+
+void VulkanSetup::createReadbackBuffer(VkDeviceSize size, VkBuffer &buffer) {
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+
+    const VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+        if ((memProperties.memoryTypes[i].propertyFlags & cached) == cached) {
+            properties = cached;
+            break;
+        }
+    }
+
+    createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, properties, buffer, true);
+}
+
+void VulkanSetup::invalidateBuffer(VkBuffer buffer) {
+    // Host-visible allocations are aligned and padded to nonCoherentAtomSize by the arena
+    const MemoryArena::Allocation& allocation = bufferAllocations.at(buffer);
+
+    VkMappedMemoryRange range = {};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+    range.offset = allocation.offset;
+    range.size = allocation.size;
+    vkInvalidateMappedMemoryRanges(device, 1, &range);
+}
+
+MemoryArena::Stats VulkanSetup::getMemoryStats() const {
+    return memoryArena.getStats();
+}
+
+void VulkanSetup::printMemoryStats() const {
+    memoryArena.printStats();
 }
 
 VkShaderModule VulkanSetup::createShaderModule(const std::vector<char>& code) {
@@ -172,3 +467,134 @@ VkShaderModule VulkanSetup::createShaderModule(const std::vector<char>& code) {
 
     return shaderModule;
 }
+
+VkPipeline VulkanSetup::createComputePipeline(const std::string& shaderFile, VkPipelineLayout layout,
+                                               const VkSpecializationInfo* specialization) {
+    // Copied out of the map, as calls from other threads share the future
+    std::vector<char> code;
+    auto prefetched = shaderPrefetch.find(shaderFile);
+    if (prefetched != shaderPrefetch.end()) {
+        std::shared_future<std::vector<char>> pending = prefetched->second;
+        code = pending.get();
+    } else {
+        code = readFile(shaderFile);
+    }
+    VkShaderModule shaderModule = createShaderModule(code);
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = specialization;
+    pipelineInfo.layout = layout;
+
+    VkPipeline pipeline;
+    if (pipelineCache.createComputePipeline(pipelineInfo, pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline: " + shaderFile);
+    }
+
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    return pipeline;
+}
+
+VulkanSetup::StartupTimes VulkanSetup::getStartupTimes() const {
+    StartupTimes times = startupTimes;
+    for (const auto& entry : shaderPrefetch) {
+        std::shared_future<std::vector<char>> pending = entry.second;
+        pending.wait();
+    }
+    for (double readMs : shaderReadMs) {
+        times.shaderReadMs += readMs;
+    }
+    return times;
+}
+
+VkPhysicalDeviceLimits VulkanSetup::getDeviceLimits() const {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    return properties.limits;
+}
+
+std::string VulkanSetup::getDeviceUUID() const {
+    VkPhysicalDeviceIDProperties idProperties = {};
+    idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &idProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    static const char digits[] = "0123456789abcdef";
+    std::string uuid;
+    for (uint32_t i = 0; i < VK_UUID_SIZE; ++i) {
+        uuid += digits[idProperties.deviceUUID[i] >> 4];
+        uuid += digits[idProperties.deviceUUID[i] & 0xf];
+    }
+    return uuid;
+}
+
+bool VulkanSetup::supportsSubgroupOperations(VkSubgroupFeatureFlags operations) const {
+    VkPhysicalDeviceSubgroupProperties subgroupProperties = {};
+    subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &subgroupProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    return (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 &&
+           (subgroupProperties.supportedOperations & operations) == operations;
+}
+
+uint32_t VulkanSetup::getSubgroupSize() const {
+    VkPhysicalDeviceSubgroupProperties subgroupProperties = {};
+    subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &subgroupProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+    return subgroupProperties.subgroupSize;
+}
+
+bool VulkanSetup::hasDeviceExtension(const char* name) const {
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+
+    for (const auto& extension : extensions) {
+        if (std::strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+VulkanSetup::ComputeUnits VulkanSetup::getComputeUnits() const {
+    // The property structs may only be chained when the device has the extension;
+    // it does not have to be enabled
+    ComputeUnits units;
+    VkPhysicalDeviceProperties2 properties = {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+
+    if (hasDeviceExtension(VK_NV_SHADER_SM_BUILTINS_EXTENSION_NAME)) {
+        VkPhysicalDeviceShaderSMBuiltinsPropertiesNV smProperties = {};
+        smProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_SM_BUILTINS_PROPERTIES_NV;
+        properties.pNext = &smProperties;
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+        units.count = smProperties.shaderSMCount;
+        units.residentSubgroups = smProperties.shaderWarpsPerSM;
+    } else if (hasDeviceExtension(VK_AMD_SHADER_CORE_PROPERTIES_EXTENSION_NAME)) {
+        VkPhysicalDeviceShaderCorePropertiesAMD coreProperties = {};
+        coreProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CORE_PROPERTIES_AMD;
+        properties.pNext = &coreProperties;
+        vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+        units.count = coreProperties.shaderEngineCount * coreProperties.shaderArraysPerEngineCount *
+                      coreProperties.computeUnitsPerShaderArray;
+        units.residentSubgroups = coreProperties.simdPerComputeUnit * coreProperties.wavefrontsPerSimd;
+    }
+    return units;
+}
@@ -1,37 +1,131 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include "memory_arena.hpp"
+#include "pipeline_cache.hpp"
+#include <future>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
 class VulkanSetup {
 public:
-    VulkanSetup();
+    // Time spent in each step of the constructor
+    struct StartupTimes {
+        double instanceMs = 0.0;   // createInstance
+        double deviceMs = 0.0;     // Physical device selection and logical device creation
+        double resourcesMs = 0.0;  // Memory arena, pipeline cache file and command pools
+        double shaderReadMs = 0.0; // Prefetched SPIR-V reads, summed over the worker threads
+        uint32_t prefetchedShaders = 0;
+    };
+
+    // `prefetchShaders` are read on worker threads while the instance and device are
+    // created; createComputePipeline then takes them from memory instead of the disk.
+    // Files missing from the list are read when they are first used.
+    explicit VulkanSetup(const std::vector<std::string>& prefetchShaders = {});
     ~VulkanSetup();
 
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
-                      VkBuffer &buffer, VkDeviceMemory &bufferMemory);
+    // Buffer memory is sub-allocated from the memory arena; release it with destroyBuffer.
+    // `transferQueueAccess` shares the buffer with the transfer queue family (concurrent
+    // sharing) when that is a different family, so no ownership transfers are needed.
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                      VkBuffer &buffer, bool transferQueueAccess = false);
+    void destroyBuffer(VkBuffer buffer);
+    // Host pointer to a HOST_VISIBLE buffer. Arena blocks stay mapped, so there is no unmap.
+    void* mapBuffer(VkBuffer buffer);
+    // One-shot copy on the compute queue, blocking until it has finished (not until the queue is idle).
+    // Waits for shader and transfer writes of earlier submissions to the source, and makes the
+    // copy visible to the host and to shaders and transfers of later submissions.
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    // Writes `data` into a buffer with TRANSFER_DST usage through a temporary staging buffer
+    void uploadBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size);
+    // DEVICE_LOCAL buffer (usage + TRANSFER_DST) filled with `data` through a staging buffer
+    void createDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags usage, const void* data, VkBuffer &buffer);
+    // Host-visible transfer destination for readback. HOST_CACHED when the device has it,
+    // so mapped reads do not go through uncached memory; read it after invalidateBuffer.
+    // Usable from both the compute and the transfer queue.
+    void createReadbackBuffer(VkDeviceSize size, VkBuffer &buffer);
+    // Makes device writes visible to a mapped, possibly non-coherent buffer
+    void invalidateBuffer(VkBuffer buffer);
+
+    MemoryArena::Stats getMemoryStats() const;
+    void printMemoryStats() const;
 
     void createCommandPool();
 
+    // Semaphore with a 64-bit counter (Vulkan 1.2 timeline semaphore)
+    VkSemaphore createTimelineSemaphore(uint64_t initialValue = 0);
+    // Blocks until the semaphore's counter has reached `value`
+    void waitTimelineSemaphore(VkSemaphore semaphore, uint64_t value);
+
     VkDevice device;
     VkQueue computeQueue;
     VkCommandPool commandPool;
+    // A queue of a transfer-only family (DMA engine) when the device has one, otherwise
+    // the compute queue. transferCommandPool allocates command buffers for it.
+    VkQueue transferQueue;
+    VkCommandPool transferCommandPool;
+    uint32_t computeQueueFamily;
+    uint32_t transferQueueFamily;
+    PipelineCache pipelineCache;
 
     VkShaderModule createShaderModule(const std::vector<char>& code);
+    // Loads a SPIR-V file and creates a compute pipeline with entry point "main" through the pipeline cache.
+    // Safe to call from several threads at once.
+    VkPipeline createComputePipeline(const std::string& shaderFile, VkPipelineLayout layout,
+                                     const VkSpecializationInfo* specialization = nullptr);
+
+    VkPhysicalDeviceLimits getDeviceLimits() const;
+    // VkPhysicalDeviceIDProperties::deviceUUID as a hex string, stable across driver updates
+    std::string getDeviceUUID() const;
+    // True when compute shaders support all of the given subgroup operations
+    bool supportsSubgroupOperations(VkSubgroupFeatureFlags operations) const;
+    // Streaming multiprocessors / compute units and the subgroups each keeps resident, from
+    // VK_NV_shader_sm_builtins or VK_AMD_shader_core_properties. Both 0 without either.
+    struct ComputeUnits {
+        uint32_t count = 0;
+        uint32_t residentSubgroups = 0;
+    };
+    ComputeUnits getComputeUnits() const;
+    uint32_t getSubgroupSize() const;
+    // shaderFloat16 and storageBuffer16BitAccess, enabled on the device when this is true
+    bool supportsHalfArithmetic() const { return halfArithmeticSupported; }
+    // runtimeDescriptorArray, partially bound and update-after-bind storage buffers and
+    // shaderStorageBufferArrayDynamicIndexing, enabled when true
+    bool supportsDescriptorIndexing() const { return descriptorIndexingSupported; }
+    // True when transferQueue is a separate queue that runs alongside the compute queue
+    bool hasDedicatedTransferQueue() const { return transferQueueFamily != computeQueueFamily; }
+    // VkQueueFamilyProperties::timestampValidBits, 0 when the family has no timestamps
+    uint32_t getTimestampValidBits(uint32_t queueFamily) const;
+    // pipelineStatisticsQuery, enabled on the device when this is true
+    bool supportsPipelineStatistics() const { return pipelineStatisticsSupported; }
+
+    // Waits for the prefetched shader reads that are still running
+    StartupTimes getStartupTimes() const;
 
 
 private:
     VkInstance instance;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-    VkDeviceMemory allocateMemory(VkBuffer buffer, VkMemoryPropertyFlags properties);
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+    bool halfArithmeticSupported = false;
+    bool descriptorIndexingSupported = false;
+    bool pipelineStatisticsSupported = false;
+    MemoryArena memoryArena;
+    std::unordered_map<VkBuffer, MemoryArena::Allocation> bufferAllocations;
+    StartupTimes startupTimes;
+    std::vector<double> shaderReadMs; // One per prefetched file, written by its worker
+    // Filled before the constructor returns and only read afterwards. Declared after
+    // shaderReadMs, so destroying it waits for the workers before their results go away.
+    std::unordered_map<std::string, std::shared_future<std::vector<char>>> shaderPrefetch;
+
+    bool hasDeviceExtension(const char* name) const;
 
     void createInstance();
     void pickPhysicalDevice();
     void createLogicalDevice();
     
     uint32_t findQueueFamily(VkQueueFlagBits queueFlags);
+    // A family with transfer but neither compute nor graphics, or `fallback` when there is none
+    uint32_t findTransferQueueFamily(uint32_t fallback);
 
 };